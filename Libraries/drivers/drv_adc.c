@@ -13,6 +13,11 @@
 #include <rtdevice.h>
 #include "fsl_lpadc.h"
 #include "fsl_spc.h"
+#ifdef BSP_USING_ADC0_DMA
+#include "fsl_ctimer.h"
+#include "fsl_edma.h"
+#include "fsl_inputmux.h"
+#endif
 
 #ifdef RT_USING_ADC
 #define BSP_USING_ADC0
@@ -49,9 +54,120 @@ static struct mcx_adc mcx_adc_obj[] =
 #endif
 };
 
+#ifdef BSP_USING_ADC0_DMA
+/*
+ * Continuous acquisition: CTIMER1 MAT0 triggers a conversion through INPUTMUX,
+ * the FIFO watermark raises a DMA request and eDMA copies RESFIFO into a RAM
+ * ring. The destination address wraps after each major loop and the channel
+ * request is never auto-cleared, so the ring keeps filling with no interrupts.
+ */
+#define ADC_DMA_RING_SIZE       (2 * BSP_ADC0_DMA_WINDOW)
+#define ADC_DMA_REQUEST         kDma0RequestMuxAdc0FifoRequest
+#define ADC_DMA_TRIGGER_SIGNAL  kINPUTMUX_Ctimer1M0ToAdc0Trigger
+#define ADC_DMA_SLOT_EMPTY      0xFFFFFFFFU     /* never a valid RESFIFO word (CMDSRC is at most 15, LOOPCNT 0) */
+
+static rt_uint32_t adc_dma_ring[ADC_DMA_RING_SIZE];
+static rt_int8_t adc_dma_channel = -1;          /* channel served by the ring, -1 when stopped */
+
+static void a153_adc_dma_start(struct mcx_adc *adc, rt_int8_t channel)
+{
+    edma_transfer_config_t xfer;
+    ctimer_config_t tim_cfg;
+    ctimer_match_config_t match;
+    int i;
+
+    for (i = 0; i < ADC_DMA_RING_SIZE; i++)
+        adc_dma_ring[i] = ADC_DMA_SLOT_EMPTY;
+
+    /* One DMA request per result */
+    LPADC_SetFIFOWatermark(adc->adc_base, 0);
+    LPADC_EnableFIFOWatermarkDMA(adc->adc_base, true);
+
+    EDMA_PrepareTransfer(&xfer, (void *)&adc->adc_base->RESFIFO, sizeof(rt_uint32_t),
+                         adc_dma_ring, sizeof(rt_uint32_t), sizeof(rt_uint32_t),
+                         sizeof(adc_dma_ring), kEDMA_PeripheralToMemory);
+    xfer.dstMajorLoopOffset = -(int32_t)sizeof(adc_dma_ring);
+    EDMA_SetTransferConfig(DMA0, BSP_ADC0_DMA_CHANNEL, &xfer, RT_NULL);
+    EDMA_SetChannelMux(DMA0, BSP_ADC0_DMA_CHANNEL, ADC_DMA_REQUEST);
+    EDMA_EnableChannelRequest(DMA0, BSP_ADC0_DMA_CHANNEL);
+
+    INPUTMUX_Init(INPUTMUX0);
+    INPUTMUX_AttachSignal(INPUTMUX0, adc_cmd2trig[adc_chl2cmd[channel]], ADC_DMA_TRIGGER_SIGNAL);
+
+    /* MAT0 toggles at twice the sample rate, one rising edge per conversion */
+    CLOCK_SetClockDiv(kCLOCK_DivCTIMER1, 1u);     /* the MRCC divider comes out of reset halted */
+    CLOCK_AttachClk(kFRO_HF_to_CTIMER1);
+    CTIMER_GetDefaultConfig(&tim_cfg);
+    CTIMER_Init(CTIMER1, &tim_cfg);
+    match.enableCounterReset = true;
+    match.enableCounterStop = false;
+    match.matchValue = CLOCK_GetCTimerClkFreq(1U) / (2U * BSP_ADC0_DMA_RATE_HZ) - 1U;
+    match.outControl = kCTIMER_Output_Toggle;
+    match.outPinInitState = false;
+    match.enableInterrupt = false;
+    CTIMER_SetupMatch(CTIMER1, kCTIMER_Match_0, &match);
+    CTIMER_StartTimer(CTIMER1);
+
+    adc_dma_channel = channel;
+}
+
+static void a153_adc_dma_stop(struct mcx_adc *adc)
+{
+    if (adc_dma_channel < 0)
+        return;
+
+    CTIMER_StopTimer(CTIMER1);
+    EDMA_DisableChannelRequest(DMA0, BSP_ADC0_DMA_CHANNEL);
+    LPADC_EnableFIFOWatermarkDMA(adc->adc_base, false);
+    adc_dma_channel = -1;
+}
+
+/*
+ * Median of the latest BSP_ADC0_DMA_WINDOW results, read straight from the ring.
+ * Slots are marked empty again once read, so a stopped trigger or DMA channel
+ * shows up as -RT_EBUSY instead of the median of the same stale samples.
+ */
+static rt_err_t a153_adc_dma_read(rt_uint32_t *value)
+{
+    rt_uint16_t window[BSP_ADC0_DMA_WINDOW];
+    rt_uint32_t remaining = EDMA_GetRemainingMajorLoopCount(DMA0, BSP_ADC0_DMA_CHANNEL);
+    rt_uint32_t next = (ADC_DMA_RING_SIZE - remaining) % ADC_DMA_RING_SIZE;
+    int i, j, n = 0;
+
+    for (i = 1; i <= BSP_ADC0_DMA_WINDOW; i++)
+    {
+        rt_uint32_t slot = (next + ADC_DMA_RING_SIZE - i) % ADC_DMA_RING_SIZE;
+        rt_uint32_t raw = adc_dma_ring[slot];
+        if (raw == ADC_DMA_SLOT_EMPTY)
+            continue;
+        adc_dma_ring[slot] = ADC_DMA_SLOT_EMPTY;   /* behind the write position, DMA reaches it only after a full lap */
+
+        rt_uint16_t sample = (rt_uint16_t)((raw & ADC_RESFIFO_D_MASK) >> ADC_RESFIFO_D_SHIFT);
+        for (j = n++; j > 0 && window[j - 1] > sample; j--)
+            window[j] = window[j - 1];
+        window[j] = sample;
+    }
+
+    if (n == 0)
+        return -RT_EBUSY;   /* no conversion has completed since the previous read */
+
+    *value = window[n / 2];
+    return RT_EOK;
+}
+#endif /* BSP_USING_ADC0_DMA */
+
 static rt_err_t a153_adc_enabled(struct rt_adc_device *device, rt_int8_t channel, rt_bool_t enabled)
 {
     struct mcx_adc *adc = (struct mcx_adc *)device->parent.user_data;
+    rt_bool_t hw_trigger = RT_FALSE;
+
+#ifdef BSP_USING_ADC0_DMA
+    /* The FIFO is drained by DMA, so only one channel can be converted */
+    if (adc_dma_channel >= 0 && adc_dma_channel != channel)
+        return -RT_EBUSY;
+    a153_adc_dma_stop(adc);
+    hw_trigger = enabled;
+#endif
 
     if (enabled)
     {
@@ -88,8 +204,12 @@ static rt_err_t a153_adc_enabled(struct rt_adc_device *device, rt_int8_t channel
         lpadc_conv_trigger_config_t trig_config;
         LPADC_GetDefaultConvTriggerConfig(&trig_config);
         trig_config.targetCommandId       = adc_chl2cmd[channel];
-        trig_config.enableHardwareTrigger = false;
+        trig_config.enableHardwareTrigger = hw_trigger;
         LPADC_SetConvTriggerConfig(adc->adc_base, adc_cmd2trig[trig_config.targetCommandId], &trig_config); /* Configurate the trigger0. */
+
+#ifdef BSP_USING_ADC0_DMA
+        a153_adc_dma_start(adc, channel);
+#endif
     }
     else
     {
@@ -112,6 +232,11 @@ static rt_err_t a153_get_adc_value(struct rt_adc_device *device, rt_int8_t chann
 
     lpadc_conv_result_t mLpadcResultConfigStruct;
 
+#ifdef BSP_USING_ADC0_DMA
+    if (channel == adc_dma_channel)
+        return a153_adc_dma_read(value);
+#endif
+
     LPADC_DoSoftwareTrigger(adc->adc_base, 1 << (adc_cmd2trig[adc_chl2cmd[channel]])); /* 1U is trigger0 mask. */
     while (!LPADC_GetConvResult(adc->adc_base, &mLpadcResultConfigStruct));
     *value = mLpadcResultConfigStruct.convValue;
@@ -142,6 +267,12 @@ static int rt_hw_adc_init(void)
     SPC0->ACTIVE_CFG1 |= 0xFFFFFFFF;
     SPC_SetActiveModeBandgapModeConfig(SPC0, kSPC_BandgapEnabledBufferEnabled);
 
+#ifdef BSP_USING_ADC0_DMA
+    edma_config_t dma_config;
+    EDMA_GetDefaultConfig(&dma_config);
+    EDMA_Init(DMA0, &dma_config);
+#endif
+
     for (i = 0; i < sizeof(mcx_adc_obj) / sizeof(mcx_adc_obj[0]); i++)
     {
         CLOCK_SetClockDiv(mcx_adc_obj[i].clock_div_name, mcx_adc_obj[i].clock_div);
@@ -27,6 +27,9 @@ typedef struct
     pwm_channels_t channel;
     pwm_clock_prescale_t prescale;
     char *name;
+    rt_uint32_t period;         /* configured period in ns, 0 until the first PWM_CMD_SET */
+    rt_uint32_t pulse;          /* last pulse width in ns */
+    rt_uint16_t modulo;         /* VAL1, the counter runs from -modulo to modulo */
 } mcx_pwm_obj_t;
 
 static mcx_pwm_obj_t mcx_pwm_list[]=
@@ -62,27 +65,82 @@ static mcx_pwm_obj_t mcx_pwm_list[]=
 
 static rt_err_t mcx_drv_pwm_get(mcx_pwm_obj_t *pwm, struct rt_pwm_configuration *configuration)
 {
+    configuration->period = pwm->period;
+    configuration->pulse = pwm->pulse;
     return RT_EOK;
 }
 
+/*
+ * Duty-only update: write the edge registers at counter resolution and let the
+ * full-cycle reload pick them up. The edges are placed at -floor(n/2) and
+ * ceil(n/2) so the high time is exactly n counts of the 2 * modulo period.
+ */
+static void mcx_drv_pwm_write_pulse(mcx_pwm_obj_t *pwm, rt_uint32_t pulse)
+{
+    PWM_Type *base = BOARD_PWM_BASEADDR;
+    rt_uint32_t span = 2U * pwm->modulo;
+    rt_uint32_t high;
+
+    if (pulse >= pwm->period)
+        high = span;
+    else
+        high = (rt_uint32_t)(((uint64_t)pulse * span + pwm->period / 2U) / pwm->period);
+
+    rt_uint16_t rise = (rt_uint16_t)(-(rt_int32_t)(high / 2U));
+    rt_uint16_t fall = (rt_uint16_t)(high - high / 2U);
+
+    /* Buffered VALx writes are ignored while LDOK is set, drop any pending load first */
+    PWM_SetPwmLdok(base, pwm->control, false);
+    if (pwm->channel == kPWM_PwmA)
+    {
+        base->SM[pwm->submodule].VAL2 = rise;
+        base->SM[pwm->submodule].VAL3 = fall;
+    }
+    else
+    {
+        base->SM[pwm->submodule].VAL4 = rise;
+        base->SM[pwm->submodule].VAL5 = fall;
+    }
+    PWM_SetPwmLdok(base, pwm->control, true);
+    pwm->pulse = pulse;
+}
+
 static rt_err_t mcx_drv_pwm_set(mcx_pwm_obj_t *pwm, struct rt_pwm_configuration *configuration)
 {
-    uint8_t dutyCyclePercent = configuration->pulse * 100 / configuration->period;
+    if (configuration->period == 0)
+        return -RT_EINVAL;
+
+    /* Same period: only the duty changes, skip the full PWM_SetupPwm() */
+    if (configuration->period == pwm->period)
+    {
+        mcx_drv_pwm_write_pulse(pwm, configuration->pulse);
+        return RT_EOK;
+    }
+
     pwm_signal_param_t pwmSignal[1];
     uint32_t pwmFrequencyInHz = 1000000000 / configuration->period;
 
     pwmSignal[0].pwmChannel       = pwm->channel;
     pwmSignal[0].level            = kPWM_HighTrue;
-    pwmSignal[0].dutyCyclePercent = dutyCyclePercent;
+    pwmSignal[0].dutyCyclePercent = 0;
     pwmSignal[0].deadtimeValue    = 0;
     pwmSignal[0].faultState       = kPWM_PwmFaultState0;
     pwmSignal[0].pwmchannelenable = true;
 
-    PWM_SetupPwm(BOARD_PWM_BASEADDR, pwm->submodule, pwmSignal, 1, kPWM_SignedCenterAligned, pwmFrequencyInHz, PWM_SRC_CLK_FREQ);
-    PWM_UpdatePwmDutycycle(BOARD_PWM_BASEADDR, pwm->submodule, pwm->channel, kPWM_SignedCenterAligned, dutyCyclePercent);
-    PWM_SetPwmLdok(BOARD_PWM_BASEADDR, pwm->control, true);
+    PWM_SetPwmLdok(BOARD_PWM_BASEADDR, pwm->control, false);
+    if (PWM_SetupPwm(BOARD_PWM_BASEADDR, pwm->submodule, pwmSignal, 1, kPWM_SignedCenterAligned,
+                     pwmFrequencyInHz, PWM_SRC_CLK_FREQ) != kStatus_Success)
+    {
+        pwm->period = 0;
+        return -RT_ERROR;
+    }
 
-    return 0;
+    /* PWM_SetupPwm() programs INIT = -modulo and VAL1 = modulo for signed center-aligned mode */
+    pwm->modulo = BOARD_PWM_BASEADDR->SM[pwm->submodule].VAL1;
+    pwm->period = configuration->period;
+    mcx_drv_pwm_write_pulse(pwm, configuration->pulse);
+
+    return RT_EOK;
 }
 
 static rt_err_t mcx_drv_pwm_enable(mcx_pwm_obj_t *pwm, struct rt_pwm_configuration *configuration)
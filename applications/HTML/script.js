@@ -35,6 +35,8 @@ document.addEventListener('DOMContentLoaded', () => {
     const candleHighEl = document.getElementById('candle_high');
     const candleLowEl = document.getElementById('candle_low');
     const candleCloseEl = document.getElementById('candle_close');
+    const candleIntervalSelect = document.getElementById('candle_interval_select');
+    const chartSubtitleEl = document.getElementById('chart_subtitle');
     const footerMessageEl = document.getElementById('footer_message');
 
     // --- State ---
@@ -45,10 +47,15 @@ document.addEventListener('DOMContentLoaded', () => {
     let pricePrecision = 1;
     let pendingData = null;
     let framePending = false;
-    const candleDurationMs = 60 * 1000;
-    const maxCandles = 240;
+    let candleDurationMs = 60 * 1000;
+    const maxCandles = 240;             // candles per history request
+    const maxLoadedCandles = 5000;      // cap on candles kept in the browser
     const candles = [];
     let currentCandle = null;
+    let lastSampleTs = null;            // proxy timestamp of the latest sample
+    let historyRequestId = 0;
+    let historyLoading = false;
+    let historyExhausted = false;
     let chart;
     let candleSeries;
     let priceScaleWheelBound = false;
@@ -248,7 +255,15 @@ document.addEventListener('DOMContentLoaded', () => {
     }
 
     function formatPeriod(timestampMs) {
-        return new Date(timestampMs).toLocaleTimeString(undefined, { hour: '2-digit', minute: '2-digit' });
+        const options = { hour: '2-digit', minute: '2-digit' };
+        if (candleDurationMs < 60 * 1000) options.second = '2-digit';
+        return new Date(timestampMs).toLocaleTimeString(undefined, options);
+    }
+
+    function formatInterval(ms) {
+        if (ms >= 3600 * 1000) return `${ms / 3600000}-hour`;
+        if (ms >= 60 * 1000) return `${ms / 60000}-minute`;
+        return `${ms / 1000}-second`;
     }
 
     function initCandlestickChart() {
@@ -306,6 +321,13 @@ document.addEventListener('DOMContentLoaded', () => {
 
         applyPricePrecision();
 
+        // Scrolling to the left edge pages in older candles from the proxy
+        chart.timeScale().subscribeVisibleLogicalRangeChange((range) => {
+            if (range && range.from < 10 && candles.length > 0) {
+                requestHistory(candles[0].bucketStart);
+            }
+        });
+
         if (!priceScaleWheelBound) {
             chartContainer.addEventListener('wheel', handlePriceScaleWheel, { passive: false });
             priceScaleWheelBound = true;
@@ -325,15 +347,82 @@ document.addEventListener('DOMContentLoaded', () => {
         }
     }
 
-    function syncCandles() {
+    function syncCandles(scrollToLatest = true) {
         if (!candleSeries) return;
         const formatted = candles.map(({ time, open, high, low, close }) => ({ time, open, high, low, close }));
         candleSeries.setData(formatted);
-        if (chart) {
+        if (chart && scrollToLatest) {
             chart.timeScale().scrollToRealTime();
         }
     }
 
+    // --- History served by the proxy (timeseries.py) ---
+    function requestHistory(endMs) {
+        if (historyLoading || historyExhausted || candles.length >= maxLoadedCandles) return;
+        if (websocket.readyState !== WebSocket.OPEN) return;
+        historyLoading = true;
+        historyRequestId += 1;
+        websocket.send(JSON.stringify({
+            type: 'history',
+            id: historyRequestId,
+            field: 'current_temperature',
+            start: endMs - maxCandles * candleDurationMs,
+            end: endMs,
+            bucket: candleDurationMs
+        }));
+    }
+
+    function applyHistory(reply) {
+        if (reply.id !== historyRequestId) return;     // superseded by an interval change
+        historyLoading = false;
+        if (reply.error || reply.bucket !== candleDurationMs) {
+            if (reply.error) console.error('History query failed:', reply.error);
+            return;
+        }
+        // An empty page only means a gap (proxy or board down); stop at the store's earliest row
+        if (reply.first === null || reply.start <= reply.first) historyExhausted = true;
+        if (reply.t.length === 0) {
+            if (!historyExhausted && reply.before !== null) requestHistory(reply.before + 1);
+            return;
+        }
+        const byBucket = new Map(candles.map((c) => [c.bucketStart, c]));
+        reply.t.forEach((bucketStart, i) => {
+            const live = byBucket.get(bucketStart);
+            if (live) {
+                // The proxy saw the whole bucket, the browser only the part since page load
+                live.open = reply.open[i];
+                live.high = Math.max(live.high, reply.high[i]);
+                live.low = Math.min(live.low, reply.low[i]);
+                return;
+            }
+            const candle = {
+                bucketStart,
+                time: Math.floor(bucketStart / 1000),
+                open: reply.open[i],
+                high: reply.high[i],
+                low: reply.low[i],
+                close: reply.close[i]
+            };
+            candles.push(candle);
+            byBucket.set(bucketStart, candle);
+        });
+        candles.sort((a, b) => a.bucketStart - b.bucketStart);
+        if (!currentCandle) currentCandle = candles[candles.length - 1];
+        syncCandles(false);
+        updateCandleSummary(currentCandle);
+    }
+
+    function resetCandles() {
+        candles.length = 0;
+        currentCandle = null;
+        historyExhausted = false;
+        historyLoading = false;
+        if (candleSeries) candleSeries.setData([]);
+        if (chart) chart.applyOptions({ timeScale: { secondsVisible: candleDurationMs < 60 * 1000 } });
+        if (chartSubtitleEl) setText(chartSubtitleEl, `${formatInterval(candleDurationMs)} candlestick view of current_temperature`);
+        requestHistory((lastSampleTs ?? Date.now()) + 1);
+    }
+
     function updateCandleSummary(candle) {
         if (!candle) return;
         if (candlePeriodEl) setText(candlePeriodEl, formatPeriod(candle.bucketStart));
@@ -343,45 +432,79 @@ document.addEventListener('DOMContentLoaded', () => {
     if (candleCloseEl) setText(candleCloseEl, formatWithPrecision(candle.close));
     }
 
-    function updateCandles(data) {
-        if (!candleSeries) return;
+    // --- Sample ring: every sample is stored on arrival, rendering drains it per frame ---
+    const SAMPLE_RING_SIZE = 1 << 16;   // ~20 min at 50 Hz; power of two for masking
+    const sampleTs = new Float64Array(SAMPLE_RING_SIZE);
+    const sampleTemp = new Float32Array(SAMPLE_RING_SIZE);
+    let sampleHead = 0;                 // samples written
+    let sampleTail = 0;                 // samples folded into candles
+
+    function pushSample(data) {
         const temp = Number(data.current_temperature);
         if (!Number.isFinite(temp)) return;
+        // Bucket by the proxy timestamp so that live candles line up with stored history
+        const ts = Number.isFinite(data.ts) ? data.ts : Date.now();
+        const slot = sampleHead & (SAMPLE_RING_SIZE - 1);
+        sampleTs[slot] = ts;
+        sampleTemp[slot] = temp;
+        sampleHead += 1;
+        lastSampleTs = ts;
+    }
 
-        const now = Date.now();
-        const bucketStart = Math.floor(now / candleDurationMs) * candleDurationMs;
-        const bucketTime = Math.floor(bucketStart / 1000);
-
-        if (!currentCandle || currentCandle.bucketStart !== bucketStart) {
-            currentCandle = {
-                bucketStart,
-                time: bucketTime,
-                open: temp,
-                high: temp,
-                low: temp,
-                close: temp
-            };
-            candles.push(currentCandle);
-            if (candles.length > maxCandles) {
-                candles.splice(0, candles.length - maxCandles);
+    function drainSamples() {
+        if (sampleHead === sampleTail) return;
+        if (sampleHead - sampleTail > SAMPLE_RING_SIZE) {
+            // Overwritten while nothing was rendering (background tab): reload from the proxy
+            sampleTail = sampleHead;
+            resetCandles();
+            return;
+        }
+        const touched = [];
+        let trimmed = false;
+        for (; sampleTail < sampleHead; sampleTail += 1) {
+            const slot = sampleTail & (SAMPLE_RING_SIZE - 1);
+            const temp = sampleTemp[slot];
+            const bucketStart = Math.floor(sampleTs[slot] / candleDurationMs) * candleDurationMs;
+
+            if (currentCandle && bucketStart < currentCandle.bucketStart) continue;
+            if (!currentCandle || currentCandle.bucketStart !== bucketStart) {
+                currentCandle = {
+                    bucketStart,
+                    time: Math.floor(bucketStart / 1000),
+                    open: temp,
+                    high: temp,
+                    low: temp,
+                    close: temp
+                };
+                candles.push(currentCandle);
+                if (candles.length > maxLoadedCandles) {
+                    candles.splice(0, candles.length - maxLoadedCandles);
+                    trimmed = true;
+                }
+            } else {
+                if (temp > currentCandle.high) currentCandle.high = temp;
+                if (temp < currentCandle.low) currentCandle.low = temp;
+                currentCandle.close = temp;
             }
-            syncCandles();
-        } else {
-            currentCandle.high = Math.max(currentCandle.high, temp);
-            currentCandle.low = Math.min(currentCandle.low, temp);
-            currentCandle.close = temp;
-            candleSeries.update({
-                time: currentCandle.time,
-                open: currentCandle.open,
-                high: currentCandle.high,
-                low: currentCandle.low,
-                close: currentCandle.close
-            });
+            if (touched[touched.length - 1] !== currentCandle) touched.push(currentCandle);
         }
 
+        if (candleSeries && touched.length > 0) {
+            if (trimmed) {
+                syncCandles();
+            } else {
+                // One series update per candle touched in this batch, oldest first
+                touched.forEach(({ time, open, high, low, close }) => candleSeries.update({ time, open, high, low, close }));
+            }
+        }
         updateCandleSummary(currentCandle);
     }
 
+    // Background tabs get no animation frames; fold samples in at a low rate instead
+    setInterval(() => {
+        if (document.hidden) drainSamples();
+    }, 1000);
+
     initCandlestickChart();
 
     function ensureRange(values) {
@@ -591,6 +714,7 @@ document.addEventListener('DOMContentLoaded', () => {
         }
         renderFeedforwardTable();
         renderWarmingTable();
+        resetCandles();
         if (footerMessageEl) {
             footerMessageEl.textContent = 'Connected to data stream';
         }
@@ -599,12 +723,18 @@ document.addEventListener('DOMContentLoaded', () => {
     websocket.onmessage = (event) => {
         try {
             const raw = JSON.parse(event.data);
+            if (raw.type) {
+                // Proxy replies carry a type, telemetry samples do not
+                if (raw.type === 'history') applyHistory(raw);
+                return;
+            }
             const data = enrichTelemetry(raw);
             if (isFirstMessage) {
                 initializeControlPanel(data);
                 isFirstMessage = false;
             }
-            // Batch DOM updates to animation frames
+            // Every sample goes into the ring now; DOM updates are batched to animation frames
+            pushSample(data);
             pendingData = data;
             if (!framePending) {
                 framePending = true;
@@ -613,7 +743,7 @@ document.addEventListener('DOMContentLoaded', () => {
                         if (pendingData) {
                             updateDashboard(pendingData);
                             updateThermometer(pendingData);
-                            updateCandles(pendingData);
+                            drainSamples();
                             cachePidGains(pendingData);
                             refreshPidInputsIfIdle();
                             if (footerMessageEl) {
@@ -654,6 +784,13 @@ document.addEventListener('DOMContentLoaded', () => {
     };
 
     // --- Event Listeners ---
+    if (candleIntervalSelect) {
+        candleIntervalSelect.addEventListener('change', () => {
+            candleDurationMs = Number(candleIntervalSelect.value);
+            resetCandles();
+        });
+    }
+
     setTargetBtn.addEventListener('click', () => {
         const targetValue = targetTemperatureInput.value;
         if (targetValue !== '') {
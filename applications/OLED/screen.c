@@ -27,10 +27,13 @@ void screen_on()
         const float slider_half_span = 30.0f; // 越小温差条波动越明显
         float delta = 0.0f;
         float slider_ratio = 0.0f;
+        control_snapshot_t snap;
+
+        control_snapshot_read(&snap);
 
         u8g2_ClearBuffer(&u8g2);
 
-        switch (control_state)
+        switch (snap.state)
         {
             case CONTROL_STATE_HEATING:
                 state_label = "HEATING";
@@ -45,12 +48,12 @@ void screen_on()
                 break;
         }
 
-        metric_values[0] = current_temperature;
-        metric_values[1] = target_temperature;
-        metric_values[2] = ptc_target_temp;
-        metric_values[3] = ptc_temperature;
+        metric_values[0] = snap.current_temperature;
+        metric_values[1] = snap.target_temperature;
+        metric_values[2] = snap.ptc_target_temp;
+        metric_values[3] = snap.ptc_temperature;
 
-        delta = current_temperature - target_temperature;
+        delta = snap.current_temperature - snap.target_temperature;
         if (slider_half_span > 0.0f)
         {
             slider_ratio = delta / slider_half_span;
@@ -0,0 +1,780 @@
+#include <math.h>
+#include <string.h>
+#include "control.h"
+
+/*******************************************************************************
+ * 参数定义
+ ******************************************************************************/
+/* 传感器信息 */
+volatile float env_temperature = 25.0f;        // 环境温度
+volatile float current_humidity = 50.0f;       // 当前湿度值
+volatile float current_temperature = 25.0f;    // 当前温度值
+volatile float target_temperature = 40.0f;     // 目标温度值
+volatile float ptc_temperature = 25.0f;        // PTC温度值
+volatile float ptc_target_temp = 40.0f;        // PTC目标温度
+
+/* 温控参数 */
+float warming_threshold = 3.0f;       // 当前保温阈值 (由前馈表决定)
+float warming_bias = 5.0f;            // 保温偏置温度（PTC温度高于目标温度多少用于保温）
+float heating_bias = 30.0f;           // 加热偏置温度（PTC温度高于目标温度多少用于加热）
+float hysteresis_band = 2.0f;         // 迟滞范围
+float fan_min = 0.00f;                // 最小风速
+float fan_max = 0.63f;                // 最大风速
+
+/* 控制状态与监控变量 */
+pid_ctx_t pid_box;  // 外环PID控制PTC目标温度
+pid_ctx_t pid_ptc;  // 内环PID控制PTC温度
+pid_ctx_t pid_cool; // 风扇 PI
+volatile control_state_t control_state = CONTROL_STATE_WARMING;
+volatile float final_pwm_duty = 0.0f;          // 当前PWM占空比
+volatile uint8_t ptc_sensor_fault = 0;         // PTC温度采样失效
+control_timing_t control_timing;
+
+static float fan_cmd = 0.0f;                   // 风扇输出一阶滤波状态
+
+/* 生效的增益调度表，只由PID线程使用；sched_target 为上次查表时的目标温度，NAN 表示需要重新查表 */
+#define CONTROL_SCHED_MATCH     0.5f           // tune sched 视为同一条目的温差 (°C)
+static gain_sched_entry_t sched_table[CONTROL_SCHED_ENTRIES];
+static int sched_count = 0;
+static float sched_target = NAN;
+
+/* 箱温状态估计，只由PID线程更新 */
+estimator_t box_estimator;
+
+/* 控制模式，由参数集切换；MPC 状态只由PID线程更新 */
+volatile control_mode_t control_mode = CONTROL_MODE_PID;
+mpc_t control_mpc;
+
+/* 热模型在线辨识，只由PID线程更新；复位请求由其他线程置位 */
+ident_t plant_ident;
+static volatile uint8_t ident_reset_request = 0;
+
+/* 状态快照顺序锁：序号为奇数表示写入中 */
+static volatile uint32_t snapshot_seq = 0;
+static control_snapshot_t snapshot_buf;
+
+/* 参数双缓冲：提交者写 params_pending，PID线程在控制周期开始时整体换入，序号为奇数表示写入中 */
+static volatile uint32_t params_seq = 0;
+static volatile uint32_t params_applied_seq = 0;
+static control_params_t params_pending;
+static control_params_t params_active;         // 只由PID线程使用
+/*******************************************************************************
+ * 前馈表
+ ******************************************************************************/
+ff_table_t ff_table = {
+    .count = 10,
+    .points = {
+        { 20.0f, 0.18f },
+        { 25.0f, 0.23f },
+        { 30.0f, 0.27f },
+        { 40.0f, 0.36f },
+        { 50.0f, 0.46f },
+        { 60.0f, 0.55f },
+        { 70.0f, 0.64f },
+        { 80.0f, 0.73f },
+        { 90.0f, 0.82f },
+        {100.0f, 0.91f }
+    }
+};
+
+ff_table_t warming_ff_table = {
+    .count = 5,
+    .points = {
+        { 25.0f, 35.0f },
+        { 30.0f, 40.5f },
+        { 40.0f, 53.0f },
+        { 57.0f, 85.0f },
+        { 70.0f, 100.0f }
+    }
+};
+
+/* 上次查表所在区间的下标，只由PID线程使用；换入新表时清零 */
+static int ff_hint = 0;
+static int warming_ff_hint = 0;
+
+/*******************************************************************************
+ * 函数定义
+ ******************************************************************************/
+static void params_capture(control_params_t *p)
+{
+    p->target_temperature = target_temperature;
+    p->hysteresis_band = hysteresis_band;
+    p->warming_bias = warming_bias;
+    p->heating_bias = heating_bias;
+    p->mode = control_mode;
+    p->box = (pid_gains_t){ pid_box.kp, pid_box.ki, pid_box.kd };
+    p->heat = (pid_gains_t){ pid_ptc.kp, pid_ptc.ki, pid_ptc.kd };
+    p->cool = (pid_gains_t){ pid_cool.kp, pid_cool.ki, pid_cool.kd };
+    p->num_sched = 0;
+    memcpy(&p->ff, &ff_table, sizeof(p->ff));
+    memcpy(&p->warming_ff, &warming_ff_table, sizeof(p->warming_ff));
+    p->plant = box_estimator.p;
+}
+
+static void params_install(const control_params_t *p)
+{
+    target_temperature = p->target_temperature;
+    hysteresis_band = p->hysteresis_band;
+    warming_bias = p->warming_bias;
+    heating_bias = p->heating_bias;
+    pid_box.kp = p->box.kp;
+    pid_box.ki = p->box.ki;
+    pid_box.kd = p->box.kd;
+    pid_ptc.kp = p->heat.kp;
+    pid_ptc.ki = p->heat.ki;
+    pid_ptc.kd = p->heat.kd;
+    pid_cool.kp = p->cool.kp;
+    pid_cool.ki = p->cool.ki;
+    pid_cool.kd = p->cool.kd;
+    sched_count = p->num_sched;
+    memcpy(sched_table, p->sched, sizeof(sched_table));
+    sched_target = NAN;
+    memcpy(&ff_table, &p->ff, sizeof(ff_table));
+    memcpy(&warming_ff_table, &p->warming_ff, sizeof(warming_ff_table));
+    ff_hint = 0;
+    warming_ff_hint = 0;
+    box_estimator.p = p->plant;     // 只换模型参数，估计状态和协方差保留
+    if (p->mode != control_mode) control_set_mode((control_mode_t)p->mode);
+}
+
+/**
+ * @brief  按当前目标温度从增益调度表取增益，目标温度不变时不重复查表
+ * @note   调度表为空时保留参数集中的固定增益
+ */
+static void sched_apply(void)
+{
+    gain_sched_entry_t g;
+
+    if (sched_count == 0 || target_temperature == sched_target) return;
+    gain_sched_lookup(sched_table, sched_count, target_temperature, &g);
+    pid_box.kp = g.box.kp;
+    pid_box.ki = g.box.ki;
+    pid_box.kd = g.box.kd;
+    pid_ptc.kp = g.heat.kp;
+    pid_ptc.ki = g.heat.ki;
+    pid_ptc.kd = g.heat.kd;
+    pid_cool.kp = g.cool.kp;
+    pid_cool.ki = g.cool.ki;
+    pid_cool.kd = g.cool.kd;
+    sched_target = target_temperature;
+}
+
+/**
+ * @brief  换入最近一次提交的参数集（控制周期开始时由PID线程调用）
+ * @note   提交者正在写入或复制期间被改写时放弃，下一个周期再换入；
+ *         PID线程优先级最高，这里从不等待
+ */
+static void params_apply_pending(void)
+{
+    uint32_t seq = params_seq;
+    if (seq == params_applied_seq || (seq & 1u)) return;
+    CONTROL_BARRIER();
+    memcpy(&params_active, &params_pending, sizeof(params_active));
+    CONTROL_BARRIER();
+    if (seq != params_seq) return;
+    params_install(&params_active);
+    params_applied_seq = seq;
+}
+
+void control_init(void)
+{
+    control_state = CONTROL_STATE_WARMING;
+    // 加热PID
+    //TODO!:(需要整定，建模中，或者可以使用一些机器学习方法，把目标函数黑盒转换为凸函数，然后做凸优化)
+    pid_ptc.kp = 1.37f;
+    pid_ptc.ki = 0.10f;
+    pid_ptc.kd = 0.70f;
+    pid_ptc.out_min = 0.0f;
+    pid_ptc.out_max = 1.0f;
+    pid_box.kp = 0.10f;
+    pid_box.ki = 0.76f;
+    pid_box.kd = 0.37f;
+    pid_box.out_min = 0.0f;
+    pid_box.out_max = 1.0f;
+    // 风冷PI (需要整定)
+    pid_cool.kp = 0.01f;
+    pid_cool.ki = 0.001f;
+    pid_cool.kd = 0.0f;
+    pid_cool.out_min = fan_min;
+    pid_cool.out_max = fan_max;
+    fan_cmd = 0.0f;
+    control_set_mode(CONTROL_MODE_PID);
+    control_estimate_init(ptc_temperature, current_temperature);
+    ident_init(&plant_ident, &box_estimator.p);
+    params_capture(&params_pending);
+    params_applied_seq = params_seq;
+    control_snapshot_publish(0, 0);
+}
+
+void control_reset_pid(pid_ctx_t *pid)
+{
+    pid->integral = 0.0f;
+    pid->prev_error = 0.0f;
+}
+
+/**
+ * @brief  切换控制模式，两种控制器都从零状态开始
+ * @note   MPC 沿用当前继电器所在的执行器，避免模式切换本身触发一次继电器动作
+ */
+void control_set_mode(control_mode_t mode)
+{
+    mpc_weights_t w;
+    mpc_default_weights(&w);
+    mpc_init(&control_mpc, &w, control_state == CONTROL_STATE_COOLING ? MPC_ACT_FAN : MPC_ACT_HEAT);
+    control_reset_pid(&pid_box);
+    control_reset_pid(&pid_ptc);
+    control_reset_pid(&pid_cool);
+    fan_cmd = 0.0f;
+    control_mode = mode;
+}
+
+/**
+ * @brief  根据箱内温度判定控制状态（带迟滞）
+ * @param  previous_state 当前状态
+ * @param  box_temp 箱内温度
+ * @return 新状态，位于 [upper_bound, upper_bound + 1) 之间时保持原状态
+ * @note   MPC 模式下继电器跟随 MPC 选定的执行器，加热侧只按箱温区分 HEATING/WARMING 用于显示
+ */
+control_state_t control_select_state(control_state_t previous_state, float box_temp)
+{
+    control_state_t state = previous_state;
+    float upper_bound = target_temperature + hysteresis_band;
+    float lower_bound = target_temperature - hysteresis_band;
+    if (control_mode == CONTROL_MODE_MPC) {
+        if (control_mpc.actuator == MPC_ACT_FAN) return CONTROL_STATE_COOLING;
+        return (box_temp < lower_bound) ? CONTROL_STATE_HEATING : CONTROL_STATE_WARMING;
+    }
+    if (box_temp < lower_bound) {
+        state = CONTROL_STATE_HEATING;
+    } else if (box_temp > upper_bound + 1) {
+        state = CONTROL_STATE_COOLING;
+    } else if (box_temp < upper_bound ) {
+        // 连续的估计值在下界附近抖动时，需越过回差才退出加热
+        if (previous_state != CONTROL_STATE_HEATING || box_temp >= lower_bound + CONTROL_STATE_DEADBAND)
+            state = CONTROL_STATE_WARMING;
+    }
+    return state;
+}
+
+/**
+ * @brief  状态切换时的控制器复位（硬件切换由调用方负责）
+ */
+void control_on_state_change(control_state_t new_state)
+{
+    if (new_state == CONTROL_STATE_COOLING) {
+        control_reset_pid(&pid_cool);
+        control_reset_pid(&pid_box);
+        control_reset_pid(&pid_ptc);
+    }
+}
+
+/**
+ * @brief  执行一个控制周期
+ * @param  dt 控制周期 (s)
+ * @return PWM占空比 (0~1)，加热/保温时驱动PTC，冷却时驱动风扇
+ * @note   调用前需更新 ptc_temperature / current_temperature
+ */
+float control_step(float dt)
+{
+    float error = 0.0f;
+    float output = 0.0f;
+
+    params_apply_pending();
+    sched_apply();
+
+    if (ptc_sensor_fault) {
+        // 没有可信的PTC温度时不能闭环，关断输出并清空积分，恢复后从零开始
+        control_reset_pid(&pid_box);
+        control_reset_pid(&pid_ptc);
+        control_reset_pid(&pid_cool);
+        final_pwm_duty = 0.0f;
+        return 0.0f;
+    }
+
+    if (control_mode == CONTROL_MODE_MPC) {
+        float duty = mpc_step(&control_mpc, &box_estimator, target_temperature, env_temperature, dt,
+                              PTC_MAX_SAFE_TEMP, pid_ptc.out_max, pid_cool.out_min, pid_cool.out_max);
+        int relay_fan = (control_state == CONTROL_STATE_COOLING);
+        // 继电器由调用方按 control_select_state 切换，切换完成前不输出
+        output = (relay_fan == (control_mpc.actuator == MPC_ACT_FAN)) ? duty : 0.0f;
+        ptc_target_temp = control_mpc.ptc_pred;
+        if (!relay_fan && ptc_temperature >= PTC_MAX_SAFE_TEMP) {
+            output = 0.0f; // 过热保护
+            CONTROL_LOG("WARNING: PTC Overheat! Temp: %.1f\n", ptc_temperature);
+        }
+        final_pwm_duty = output;
+        return output;
+    }
+
+    switch(control_state)
+    {
+        case CONTROL_STATE_HEATING:
+        case CONTROL_STATE_WARMING:
+        {
+            // 外环PID：控制箱内温度，输出PTC的目标温度
+            float outer_error = target_temperature - current_temperature;
+            pid_box.integral += outer_error * dt;
+            if(pid_box.integral > 100.0f) pid_box.integral = 100.0f;
+            if(pid_box.integral < -100.0f) pid_box.integral = -100.0f;
+            float outer_derivative = (outer_error - pid_box.prev_error) / dt;
+            float outer_output = pid_box.kp * outer_error + pid_box.ki * pid_box.integral + pid_box.kd * outer_derivative;
+            // 计算PTC目标温度
+            ptc_target_temp = get_warming_temp(target_temperature) + outer_output;
+            float ratio = fabs(outer_error + hysteresis_band) / (hysteresis_band * 2);
+            if (ratio > 1) ratio = 1;
+            float dynamic_bias = warming_bias + (heating_bias - warming_bias) * ratio;
+            if (ptc_target_temp > target_temperature + dynamic_bias) ptc_target_temp = target_temperature + dynamic_bias;
+            else if (ptc_target_temp < target_temperature + warming_bias) ptc_target_temp = target_temperature + warming_bias;
+            if (ptc_target_temp > PTC_MAX_SAFE_TEMP) ptc_target_temp = PTC_MAX_SAFE_TEMP;
+
+            pid_box.prev_error = outer_error;
+
+            // 内环PID：控制PTC温度到ptc_target_temp
+            if (ptc_temperature >= PTC_MAX_SAFE_TEMP) {
+                output = 0.0f; // 过热保护
+                CONTROL_LOG("WARNING: PTC Overheat! Temp: %.1f\n", ptc_temperature);
+            } else {
+                float inner_error = ptc_target_temp - ptc_temperature;
+                pid_ptc.integral += inner_error * dt;
+                if(pid_ptc.integral > 50.0f) pid_ptc.integral = 50.0f;
+                if(pid_ptc.integral < -50.0f) pid_ptc.integral = -50.0f;
+                float inner_derivative = (inner_error - pid_ptc.prev_error) / dt;
+                output = pid_ptc.kp * inner_error + pid_ptc.ki * pid_ptc.integral + pid_ptc.kd * inner_derivative;
+                output += get_feedforward_pwm(ptc_target_temp);
+                if (output > pid_ptc.out_max) output = pid_ptc.out_max;
+                if (output < pid_ptc.out_min) output = pid_ptc.out_min;
+                pid_ptc.prev_error = inner_error;
+            }
+            break;
+        }
+        case CONTROL_STATE_COOLING:
+            // 风扇 PI 控制
+            error = current_temperature - target_temperature;
+            pid_cool.integral += error * dt;
+            if(pid_cool.integral > 50.0f) pid_cool.integral = 50.0f;
+            if(pid_cool.integral < -50.0f) pid_cool.integral = -50.0f;
+            output = pid_cool.kp * error + pid_cool.ki * pid_cool.integral;
+            fan_cmd = fan_cmd + 0.37 * (output - fan_cmd);// 一阶滤波平滑输出
+            output = fan_cmd;
+            if (output > pid_cool.out_max) output = pid_cool.out_max;
+            if (output < pid_cool.out_min) output = pid_cool.out_min;
+            pid_cool.prev_error = error;
+            break;
+        default:
+            output = 0.0f;
+            pid_box.integral *= 0.98f;
+            pid_ptc.integral *= 0.98f;
+            pid_cool.integral *= 0.98f;
+            break;
+    }
+
+    final_pwm_duty = output;
+    return output;
+}
+
+/**
+ * @brief  以给定温度重置状态估计
+ */
+void control_estimate_init(float t_ptc, float t_box)
+{
+    estimator_params_t params;
+    estimator_default(&params);
+    estimator_init(&box_estimator, &params, t_ptc, t_box);
+}
+
+/**
+ * @brief  更新箱温估计，在 control_step 之前调用
+ * @param  dt 控制周期 (s)
+ * @param  relay_heat 上一周期输出是否作用于PTC（否则作用于风扇）
+ * @note   以上一周期的 final_pwm_duty 和 env_temperature 预测一步，再融合本周期的
+ *         ptc_temperature，结果写入 current_temperature；外环及其微分项因此工作在
+ *         10 Hz 的平滑估计上，而不是 DHT11 的 1°C 阶梯
+ */
+void control_estimate(float dt, uint8_t relay_heat)
+{
+    float duty = final_pwm_duty;
+    estimator_predict(&box_estimator, dt, relay_heat ? duty : 0.0f, relay_heat ? 0.0f : duty, env_temperature);
+    estimator_update_ptc(&box_estimator, ptc_temperature);
+    current_temperature = box_estimator.x[1];
+}
+
+/**
+ * @brief  融合一个新的箱温样本
+ * @param  age 样本采样时刻距今的时间 (s)
+ * @return 样本被新息门限拒绝时返回 0
+ */
+int control_estimate_box(float measured, float age)
+{
+    int accepted = estimator_update_box(&box_estimator, measured, age);
+    current_temperature = box_estimator.x[1];
+    return accepted;
+}
+
+/**
+ * @brief  送入一个控制周期的辨识数据，在 control_step 之前调用
+ * @param  relay_heat 上一周期输出是否作用于PTC；风扇侧的数据不参与辨识
+ * @param  box_measured 最近一次箱温实测值
+ * @note   箱温用实测值而不是状态估计：估计值受估计器自身模型约束，用它辨识会把
+ *         模型误差原样辨识回来
+ */
+void control_identify(float dt, uint8_t relay_heat, float box_measured)
+{
+    if (ident_reset_request) {
+        ident_reset_request = 0;
+        estimator_params_t prior;
+        estimator_default(&prior);      // 从默认模型重新辨识，不沿用 ident apply 换入的模型
+        ident_init(&plant_ident, &prior);
+    }
+    ident_update(&plant_ident, dt, final_pwm_duty, ptc_temperature, box_measured, env_temperature, relay_heat);
+}
+
+/**
+ * @brief  请求从先验参数重新开始辨识（任意线程可调用，下一个控制周期生效）
+ */
+void control_ident_reset(void)
+{
+    ident_reset_request = 1;
+}
+
+/**
+ * @brief  按辨识结果重新生成参数集中的两张前馈表，并改写估计器/MPC 的热模型
+ * @param  t_env 生成时的环境温度
+ * @return 模型尚未收敛时返回 -1，参数集不变
+ * @note   温度节点保持不变，只改写对应的占空比/PTC温度
+ */
+int control_ident_tables(control_params_t *params, const ident_model_t *model, float t_env)
+{
+    if (!model->valid) return -1;
+    for (int i = 0; i < params->ff.count; i++) {
+        ff_point_t *pt = &params->ff.points[i];
+        pt->value = ident_ff_pwm(model, pt->temp, t_env);
+    }
+    for (int i = 0; i < params->warming_ff.count; i++) {
+        ff_point_t *pt = &params->warming_ff.points[i];
+        float ptc = ident_warming_ptc(model, pt->temp, t_env);
+        pt->value = (ptc > PTC_MAX_SAFE_TEMP) ? PTC_MAX_SAFE_TEMP : ptc;
+    }
+    ident_estimator_params(model, &params->plant);
+    return 0;
+}
+
+/**
+ * @brief  记录一次实测控制周期，并返回送入PID的dt
+ * @param  dt_measured 与上一周期开始时刻的实测间隔 (s)
+ * @param  missed_ticks 本周期之前错过的定时节拍数
+ * @return 限幅到 [CONTROL_DT_MIN, CONTROL_DT_MAX] 的dt，避免异常间隔放大微分项
+ * @note   第一个周期的间隔从线程启动算起，不计入统计
+ */
+float control_timing_update(float dt_measured, uint32_t missed_ticks)
+{
+    const float period = CONTROL_PERIOD_MS / 1000.0f;
+    control_timing_t *t = &control_timing;
+
+    t->overruns += missed_ticks;
+    t->dt_last = dt_measured;
+    if (t->cycles++ == 0) {
+        t->dt_min = period;
+        t->dt_max = period;
+        t->jitter_rms = 0.0f;
+        return period;
+    }
+
+    if (dt_measured < t->dt_min) t->dt_min = dt_measured;
+    if (dt_measured > t->dt_max) t->dt_max = dt_measured;
+    float dev = dt_measured - period;
+    t->jitter_rms = sqrtf(t->jitter_rms * t->jitter_rms * 0.99f + dev * dev * 0.01f);
+
+    if (dt_measured < CONTROL_DT_MIN) return CONTROL_DT_MIN;
+    if (dt_measured > CONTROL_DT_MAX) return CONTROL_DT_MAX;
+    return dt_measured;
+}
+
+void control_timing_reset(void)
+{
+    control_timing.cycles = 0;
+    control_timing.overruns = 0;
+    control_timing.compute_max = 0.0f;
+}
+
+/**
+ * @brief  记录本周期状态估计+控制律的计算耗时
+ * @param  seconds 实测耗时 (s)，由调用方用周期计数器测量
+ */
+void control_timing_compute(float seconds)
+{
+    control_timing.compute_last = seconds;
+    if (seconds > control_timing.compute_max) control_timing.compute_max = seconds;
+}
+
+/**
+ * @brief  发布本周期的控制器状态快照（只允许PID线程调用）
+ * @param  timestamp_ms 发布时刻 (ms)
+ * @param  relay_heat 继电器是否处于加热侧
+ * @note   写者从不阻塞；写入期间序号为奇数，读者据此重试
+ */
+void control_snapshot_publish(uint32_t timestamp_ms, uint8_t relay_heat)
+{
+    control_snapshot_t *s = &snapshot_buf;
+
+    snapshot_seq++;
+    CONTROL_BARRIER();
+    s->cycle = control_timing.cycles;
+    s->timestamp_ms = timestamp_ms;
+    s->state = control_state;
+    s->mode = control_mode;
+    s->num_sched = (uint8_t)sched_count;
+    s->relay_heat = relay_heat;
+    s->ptc_sensor_fault = ptc_sensor_fault;
+    s->ptc_temperature = ptc_temperature;
+    s->current_temperature = current_temperature;
+    s->target_temperature = target_temperature;
+    s->ptc_target_temp = ptc_target_temp;
+    s->box_std = sqrtf(box_estimator.P[1][1]);
+    s->current_humidity = current_humidity;
+    s->env_temperature = env_temperature;
+    s->pwm_duty = final_pwm_duty;
+    s->pid_box = pid_box;
+    s->pid_ptc = pid_ptc;
+    s->pid_cool = pid_cool;
+    s->warming_bias = warming_bias;
+    s->heating_bias = heating_bias;
+    s->warming_threshold = warming_threshold;
+    s->hysteresis_band = hysteresis_band;
+    s->timing = control_timing;
+    s->ident = plant_ident.model;
+    CONTROL_BARRIER();
+    snapshot_seq++;
+}
+
+/**
+ * @brief  读取最近一次发布的状态快照
+ * @param  snap 输出，保证各字段来自同一个控制周期
+ * @note   PID线程优先级高于所有读者，读者被写入打断时重试即可，不会活锁
+ */
+void control_snapshot_read(control_snapshot_t *snap)
+{
+    uint32_t seq;
+    do {
+        do {
+            seq = snapshot_seq;
+        } while (seq & 1u);
+        CONTROL_BARRIER();
+        memcpy(snap, &snapshot_buf, sizeof(*snap));
+        CONTROL_BARRIER();
+    } while (seq != snapshot_seq);
+}
+
+/**
+ * @brief  取得最近一次提交的参数集（可能尚未被PID线程换入）
+ * @note   与 control_params_commit 一样，多个线程调用时须由调用方串行化
+ */
+void control_params_get(control_params_t *params)
+{
+    memcpy(params, &params_pending, sizeof(*params));
+}
+
+/**
+ * @brief  提交一组参数，PID线程在下一个控制周期开始时整体换入
+ * @note   同一周期内多次提交只有最后一次生效；提交者之间须由调用方串行化
+ */
+void control_params_commit(const control_params_t *params)
+{
+    params_seq++;
+    CONTROL_BARRIER();
+    memcpy(&params_pending, params, sizeof(params_pending));
+    CONTROL_BARRIER();
+    params_seq++;
+}
+
+/**
+ * @return 有已提交但尚未换入的参数时返回 1
+ */
+int control_params_pending(void)
+{
+    return params_seq != params_applied_seq;
+}
+
+static pid_gains_t gains_lerp(const pid_gains_t *a, const pid_gains_t *b, float ratio)
+{
+    pid_gains_t g;
+    g.kp = a->kp + ratio * (b->kp - a->kp);
+    g.ki = a->ki + ratio * (b->ki - a->ki);
+    g.kd = a->kd + ratio * (b->kd - a->kd);
+    return g;
+}
+
+/**
+ * @brief  在增益调度表中查找目标温度对应的增益
+ * @param  table 按 target_temp 升序排列，count > 0
+ * @param  out 插值结果，target_temp 为查询温度
+ * @note   二分查找所在区间后线性插值，超出表范围时取端点
+ */
+void gain_sched_lookup(const gain_sched_entry_t *table, int count, float target_temp, gain_sched_entry_t *out)
+{
+    if (target_temp <= table[0].target_temp) {
+        *out = table[0];
+    } else if (target_temp >= table[count - 1].target_temp) {
+        *out = table[count - 1];
+    } else {
+        // 不变式：table[lo].target_temp <= target_temp < table[hi].target_temp
+        int lo = 0;
+        int hi = count - 1;
+        while (hi - lo > 1) {
+            int mid = (lo + hi) / 2;
+            if (table[mid].target_temp <= target_temp) lo = mid;
+            else hi = mid;
+        }
+        const gain_sched_entry_t *a = &table[lo];
+        const gain_sched_entry_t *b = &table[hi];
+        float ratio = (target_temp - a->target_temp) / (b->target_temp - a->target_temp);
+        out->box = gains_lerp(&a->box, &b->box, ratio);
+        out->heat = gains_lerp(&a->heat, &b->heat, ratio);
+        out->cool = gains_lerp(&a->cool, &b->cool, ratio);
+    }
+    out->target_temp = target_temp;
+}
+
+static int gain_sched_find(const control_params_t *params, float target_temp)
+{
+    for (int i = 0; i < params->num_sched; i++)
+        if (fabsf(params->sched[i].target_temp - target_temp) < CONTROL_SCHED_MATCH) return i;
+    return -1;
+}
+
+/**
+ * @brief  查找目标温度对应的调度条目，不存在时按顺序插入
+ * @return 条目下标；表已满时返回 -1
+ * @note   新条目的增益取插入前在该温度的插值结果（表为空时取固定增益），
+ *         因此插入本身不改变任何工作点的增益
+ */
+int gain_sched_upsert(control_params_t *params, float target_temp)
+{
+    int index = gain_sched_find(params, target_temp);
+    if (index >= 0) return index;
+    if (params->num_sched >= CONTROL_SCHED_ENTRIES) return -1;
+
+    gain_sched_entry_t entry;
+    if (params->num_sched > 0) {
+        gain_sched_lookup(params->sched, params->num_sched, target_temp, &entry);
+    } else {
+        entry.target_temp = target_temp;
+        entry.box = params->box;
+        entry.heat = params->heat;
+        entry.cool = params->cool;
+    }
+
+    index = params->num_sched;
+    while (index > 0 && params->sched[index - 1].target_temp > target_temp) {
+        params->sched[index] = params->sched[index - 1];
+        index--;
+    }
+    params->sched[index] = entry;
+    params->num_sched++;
+    return index;
+}
+
+/**
+ * @brief  删除目标温度对应的调度条目
+ * @return 找不到时返回 -1
+ */
+int gain_sched_remove(control_params_t *params, float target_temp)
+{
+    int index = gain_sched_find(params, target_temp);
+    if (index < 0) return -1;
+    for (int i = index; i < params->num_sched - 1; i++)
+        params->sched[i] = params->sched[i + 1];
+    params->num_sched--;
+    return 0;
+}
+
+/**
+ * @brief  前馈表查表
+ * @param  hint 上次查表所在区间的下标，命中时不再二分查找；由调用方保存
+ * @return 区间内线性插值，超出表范围时取端点；表为空时返回 0
+ * @note   目标温度在两次查表之间通常不变或只移动一点，区间提示几乎总能命中；
+ *         提示越界（表被换入或缩短）时按未命中处理
+ */
+float ff_table_lookup(const ff_table_t *table, float temp, int *hint)
+{
+    const ff_point_t *pts = table->points;
+    int n = table->count;
+
+    if (n == 0) return 0.0f;
+    if (temp <= pts[0].temp) return pts[0].value;
+    if (temp >= pts[n - 1].temp) return pts[n - 1].value;
+
+    int lo = *hint;
+    if (lo < 0 || lo >= n - 1 || temp < pts[lo].temp || temp >= pts[lo + 1].temp) {
+        // 不变式：pts[lo].temp <= temp < pts[hi].temp
+        lo = 0;
+        int hi = n - 1;
+        while (hi - lo > 1) {
+            int mid = (lo + hi) / 2;
+            if (pts[mid].temp <= temp) lo = mid;
+            else hi = mid;
+        }
+        *hint = lo;
+    }
+    const ff_point_t *a = &pts[lo];
+    const ff_point_t *b = &pts[lo + 1];
+    float ratio = (temp - a->temp) / (b->temp - a->temp);
+    return a->value + ratio * (b->value - a->value);
+}
+
+/**
+ * @brief  二分查找 temp 在表中的插入位置，即第一个温度不小于 temp - CONTROL_FF_MATCH 的点
+ */
+static int ff_table_bound(const ff_table_t *table, float temp)
+{
+    int lo = 0;
+    int hi = table->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (table->points[mid].temp < temp - CONTROL_FF_MATCH) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief  设置温度点的值，不存在时按顺序插入
+ * @return 点的下标；表已满时返回 -1
+ */
+int ff_table_set(ff_table_t *table, float temp, float value)
+{
+    int index = ff_table_bound(table, temp);
+    if (index < table->count && table->points[index].temp <= temp + CONTROL_FF_MATCH) {
+        table->points[index].value = value;
+        return index;
+    }
+    if (table->count >= CONTROL_FF_CAPACITY) return -1;
+
+    memmove(&table->points[index + 1], &table->points[index], (table->count - index) * sizeof(ff_point_t));
+    table->points[index].temp = temp;
+    table->points[index].value = value;
+    table->count++;
+    return index;
+}
+
+/**
+ * @brief  删除温度点
+ * @return 找不到时返回 -1
+ */
+int ff_table_remove(ff_table_t *table, float temp)
+{
+    int index = ff_table_bound(table, temp);
+    if (index >= table->count || table->points[index].temp > temp + CONTROL_FF_MATCH) return -1;
+    memmove(&table->points[index], &table->points[index + 1], (table->count - index - 1) * sizeof(ff_point_t));
+    table->count--;
+    return 0;
+}
+
+float get_feedforward_pwm(float target_temp)
+{
+    return ff_table_lookup(&ff_table, target_temp, &ff_hint);
+}
+
+float get_warming_temp(float target_temp)
+{
+    return ff_table_lookup(&warming_ff_table, target_temp, &warming_ff_hint);
+}
@@ -0,0 +1,206 @@
+#ifndef CONTROL_H
+#define CONTROL_H
+
+/*******************************************************************************
+ * 温控控制律
+ *
+ * 本模块只包含与硬件无关的控制逻辑（状态机判定、级联PID、前馈表），
+ * 不依赖任何外设，因此既链接进固件，也可以在PC上与 sim/ 下的热模型
+ * 一起编译，用于离线仿真与调参。
+ *
+ * 主机编译时定义 CONTROL_SIM，以标准C库替代 RT-Thread 接口。
+ ******************************************************************************/
+#include <stdint.h>
+#include "estimator.h"
+#include "mpc.h"
+#include "ident.h"
+#ifdef CONTROL_SIM
+#include <stdio.h>
+#define CONTROL_LOG         printf
+#ifndef PTC_MAX_SAFE_TEMP
+#define PTC_MAX_SAFE_TEMP   110
+#endif
+#else
+#include <rtthread.h>
+#define CONTROL_LOG         rt_kprintf
+#endif
+#define CONTROL_BARRIER()   __sync_synchronize()    // 编译器+内存屏障 (Cortex-M 上为 DMB)
+
+#define SAMPLE_PERIOD_MS    1000          	// 主线程采样周期 (ms)
+#define CONTROL_PERIOD_MS 	100         	// PID控制周期 (ms)
+#define CONTROL_DT_MIN      (CONTROL_PERIOD_MS * 0.5f / 1000.0f)   // 送入PID的dt下限 (s)
+#define CONTROL_DT_MAX      (CONTROL_PERIOD_MS * 3.0f / 1000.0f)   // 送入PID的dt上限 (s)
+#define CONTROL_STATE_DEADBAND  0.3f    // HEATING → WARMING 的回差 (°C)
+
+/* PID 控制器 */
+typedef struct {
+    float kp;
+    float ki;
+    float kd;
+    float integral;
+    float prev_error;
+    float out_min;
+    float out_max;
+} pid_ctx_t;
+
+typedef enum {
+    CONTROL_MODE_PID = 0,         // 三态状态机 + 级联PID
+    CONTROL_MODE_MPC              // 模型预测控制
+} control_mode_t;
+
+typedef enum {
+	CONTROL_STATE_HEATING=0,
+	CONTROL_STATE_WARMING,
+	CONTROL_STATE_COOLING
+} control_state_t;
+
+/* 控制周期统计 */
+typedef struct {
+    uint32_t cycles;        // 已执行的控制周期数
+    uint32_t overruns;      // 错过的定时节拍数（上一周期未按时完成）
+    float dt_last;          // 最近一次实测周期 (s)
+    float dt_min;           // 实测周期最小值 (s)
+    float dt_max;           // 实测周期最大值 (s)
+    float jitter_rms;       // 周期偏差均方根，指数加权 (s)
+    float compute_last;     // 最近一次状态估计+控制律的计算耗时 (s)
+    float compute_max;      // 计算耗时最大值 (s)
+} control_timing_t;
+
+/* 控制器状态快照，PID线程每个控制周期发布一次，读者通过顺序锁取得一致副本 */
+typedef struct {
+    uint32_t cycle;               // 发布时的控制周期序号
+    uint32_t timestamp_ms;        // 发布时刻 (ms)
+    control_state_t state;        // 控制状态
+    uint8_t mode;                 // control_mode_t
+    uint8_t relay_heat;           // 继电器处于加热侧
+    uint8_t num_sched;            // 生效的增益调度表条目数
+    uint8_t ptc_sensor_fault;     // PTC温度采样失效，输出被强制为 0
+    float ptc_temperature;        // PTC温度
+    float current_temperature;    // 箱内温度
+    float target_temperature;     // 目标温度
+    float ptc_target_temp;        // PTC目标温度
+    float box_std;                // 箱温估计标准差
+    float current_humidity;       // 湿度
+    float env_temperature;        // 环境温度
+    float pwm_duty;               // 本周期输出占空比
+    pid_ctx_t pid_box;            // 外环PID（含积分与上一误差）
+    pid_ctx_t pid_ptc;            // 内环PID
+    pid_ctx_t pid_cool;           // 风扇 PI
+    float warming_bias;
+    float heating_bias;
+    float warming_threshold;
+    float hysteresis_band;
+    control_timing_t timing;      // 控制周期统计
+    ident_model_t ident;          // 在线辨识的热模型
+} control_snapshot_t;
+
+/* 前馈表：按温度升序排列，相邻点之间线性插值，超出范围取端点 */
+#define CONTROL_FF_CAPACITY         64      // 每张前馈表的容量
+#define CONTROL_FF_MATCH            0.05f   // 视为同一个点的温差 (°C)
+
+typedef struct {
+    float temp;                   // ff_table: PTC目标温度；warming_ff_table: 目标箱温
+    float value;                  // ff_table: PWM占空比；warming_ff_table: 维持目标温度需要的PTC温度
+} ff_point_t;
+
+typedef struct {
+    uint8_t count;
+    ff_point_t points[CONTROL_FF_CAPACITY];
+} ff_table_t;
+
+/* PID 增益 */
+typedef struct {
+    float kp;
+    float ki;
+    float kd;
+} pid_gains_t;
+
+/* 增益调度表：按目标温度升序排列，相邻条目之间线性插值，超出范围取端点；为空时使用固定增益 */
+#define CONTROL_SCHED_ENTRIES       8       // 增益调度表容量
+
+typedef struct {
+    float target_temp;            // 目标箱温
+    pid_gains_t box;
+    pid_gains_t heat;
+    pid_gains_t cool;
+} gain_sched_entry_t;
+
+/* 可在线调整的参数集，tune 以整组为单位提交，PID线程在控制周期开始时整体换入 */
+typedef struct {
+    float target_temperature;
+    float hysteresis_band;
+    float warming_bias;
+    float heating_bias;
+    uint8_t mode;                 // control_mode_t
+    pid_gains_t box;              // 外环PID
+    pid_gains_t heat;             // 内环PID
+    pid_gains_t cool;             // 风扇 PI（kd 不使用）
+    uint8_t num_sched;            // 增益调度表条目数，非零时取代上面三组固定增益
+    gain_sched_entry_t sched[CONTROL_SCHED_ENTRIES];
+    ff_table_t ff;                // PTC目标温度 → 占空比
+    ff_table_t warming_ff;        // 目标箱温 → 保温PTC温度
+    estimator_params_t plant;     // 状态估计和 MPC 使用的热模型，ident apply 时按辨识结果改写
+} control_params_t;
+
+/* 传感器信息 */
+extern volatile float env_temperature;        // 环境温度
+extern volatile float current_humidity;       // 当前湿度值
+extern volatile float current_temperature;    // 当前温度值
+extern volatile float target_temperature;     // 目标温度值
+extern volatile float ptc_temperature;        // PTC温度值
+extern volatile float ptc_target_temp;        // PTC目标温度
+/* 温控参数 */
+extern float warming_threshold;       // 当前保温阈值 (由前馈表决定)
+extern float warming_bias;            // 保温偏置温度（PTC温度高于目标温度多少用于保温）
+extern float heating_bias;           // 加热偏置温度（PTC温度高于目标温度多少用于加热）
+extern float hysteresis_band;         // 迟滞范围
+extern float fan_min;                // 最小风速
+extern float fan_max;                // 最大风速
+
+/* 控制状态与监控变量 */
+extern pid_ctx_t pid_box;  // 外环PID控制PTC目标温度
+extern pid_ctx_t pid_ptc;  // 内环PID控制PTC温度
+extern pid_ctx_t pid_cool; // 风扇 PI
+extern volatile control_state_t control_state;
+extern volatile float final_pwm_duty;          // 当前PWM占空比
+extern volatile uint8_t ptc_sensor_fault;      // PTC温度采样失效（由采样方置位），control_step 输出 0
+extern control_timing_t control_timing;
+extern estimator_t box_estimator;
+extern volatile control_mode_t control_mode;
+extern mpc_t control_mpc;
+extern ident_t plant_ident;
+
+extern ff_table_t ff_table;
+extern ff_table_t warming_ff_table;
+
+/* 控制接口 */
+void control_init(void);
+control_state_t control_select_state(control_state_t previous_state, float box_temp);
+void control_on_state_change(control_state_t new_state);
+void control_reset_pid(pid_ctx_t *pid);
+void control_set_mode(control_mode_t mode);
+float control_step(float dt);
+void control_estimate_init(float t_ptc, float t_box);
+void control_estimate(float dt, uint8_t relay_heat);
+int control_estimate_box(float measured, float age);
+void control_identify(float dt, uint8_t relay_heat, float box_measured);
+void control_ident_reset(void);
+int control_ident_tables(control_params_t *params, const ident_model_t *model, float t_env);
+float control_timing_update(float dt_measured, uint32_t missed_ticks);
+void control_timing_reset(void);
+void control_timing_compute(float seconds);
+void control_snapshot_publish(uint32_t timestamp_ms, uint8_t relay_heat);
+void control_snapshot_read(control_snapshot_t *snap);
+void control_params_get(control_params_t *params);
+void control_params_commit(const control_params_t *params);
+int control_params_pending(void);
+void gain_sched_lookup(const gain_sched_entry_t *table, int count, float target_temp, gain_sched_entry_t *out);
+int gain_sched_upsert(control_params_t *params, float target_temp);
+int gain_sched_remove(control_params_t *params, float target_temp);
+float ff_table_lookup(const ff_table_t *table, float temp, int *hint);
+int ff_table_set(ff_table_t *table, float temp, float value);
+int ff_table_remove(ff_table_t *table, float temp);
+float get_feedforward_pwm(float target_temp);
+float get_warming_temp(float target_temp);
+
+#endif /* CONTROL_H */
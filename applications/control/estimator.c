@@ -0,0 +1,150 @@
+#include "estimator.h"
+
+/*******************************************************************************
+ * 参数定义
+ ******************************************************************************/
+#define ESTIMATOR_GATE_SIGMA2   25.0f   // 新息门限 (5σ)，超出时视为误读丢弃
+#define ESTIMATOR_REJECT_RUN    3       // 连续拒绝次数达到该值后强制重新跟随实测
+#define ESTIMATOR_VAR_MIN       1e-6f
+#define ESTIMATOR_VAR_MAX       1e4f
+
+/*******************************************************************************
+ * 函数定义
+ ******************************************************************************/
+/**
+ * @brief  默认参数
+ * @note   热模型参数与 thermal_plant_default() 一致；
+ *         DHT11 方差 = 量化 1/12 + 约 0.3°C 的器件误差
+ */
+void estimator_default(estimator_params_t *params)
+{
+    params->c_ptc = 20.0f;
+    params->c_box = 800.0f;
+    params->g_ptc_box = 0.30f;
+    params->g_box_env = 0.20f;
+    params->g_fan = 6.0f;
+    params->fan_ptc_gain = 2.0f;
+    params->p_ptc_max = 20.0f;
+    params->q_ptc = 0.05f;
+    params->q_box = 0.0004f;
+    params->r_ptc = 0.05f * 0.05f;
+    params->r_box = 1.0f / 12.0f + 0.09f;
+}
+
+void estimator_init(estimator_t *est, const estimator_params_t *params, float t_ptc, float t_box)
+{
+    est->p = *params;
+    est->x[0] = t_ptc;
+    est->x[1] = t_box;
+    est->P[0][0] = 1.0f;
+    est->P[0][1] = 0.0f;
+    est->P[1][0] = 0.0f;
+    est->P[1][1] = 4.0f;      // 上电时箱温未知，先信任前几次DHT11读数
+    est->dtb_dt = 0.0f;
+    est->box_updates = 0;
+    est->box_rejects = 0;
+    est->box_reject_run = 0;
+}
+
+static float clamp_var(float v)
+{
+    if (v < ESTIMATOR_VAR_MIN) return ESTIMATOR_VAR_MIN;
+    if (v > ESTIMATOR_VAR_MAX) return ESTIMATOR_VAR_MAX;
+    return v;
+}
+
+/**
+ * @brief  按热模型预测一步
+ * @param  dt 与上一次预测的间隔 (s)
+ * @param  heat_duty 上一周期施加在PTC上的占空比 (0~1)
+ * @param  fan_duty 上一周期施加在风扇上的占空比 (0~1)
+ * @param  t_env 环境温度
+ */
+void estimator_predict(estimator_t *est, float dt, float heat_duty, float fan_duty, float t_env)
+{
+    const estimator_params_t *p = &est->p;
+    float tp = est->x[0], tb = est->x[1];
+
+    if (heat_duty < 0.0f) heat_duty = 0.0f;
+    if (heat_duty > 1.0f) heat_duty = 1.0f;
+    if (fan_duty < 0.0f) fan_duty = 0.0f;
+    if (fan_duty > 1.0f) fan_duty = 1.0f;
+
+    float g_pb = p->g_ptc_box * (1.0f + p->fan_ptc_gain * fan_duty);
+    float g_be = p->g_box_env + p->g_fan * fan_duty;
+    float q_pb = g_pb * (tp - tb);
+
+    est->dtb_dt = (q_pb - g_be * (tb - t_env)) / p->c_box;
+    est->x[0] = tp + (p->p_ptc_max * heat_duty - q_pb) / p->c_ptc * dt;
+    est->x[1] = tb + est->dtb_dt * dt;
+
+    // 离散化转移矩阵 F = I + A*dt
+    float a = g_pb / p->c_ptc * dt;
+    float b = g_pb / p->c_box * dt;
+    float c = g_be / p->c_box * dt;
+    float f00 = 1.0f - a, f01 = a;
+    float f10 = b,        f11 = 1.0f - b - c;
+
+    // P = F P F' + Q
+    float p00 = est->P[0][0], p01 = est->P[0][1], p11 = est->P[1][1];
+    float m00 = f00 * p00 + f01 * p01;
+    float m01 = f00 * p01 + f01 * p11;
+    float m10 = f10 * p00 + f11 * p01;
+    float m11 = f10 * p01 + f11 * p11;
+    est->P[0][0] = clamp_var(m00 * f00 + m01 * f01 + p->q_ptc * dt);
+    est->P[0][1] = m00 * f10 + m01 * f11;
+    est->P[1][0] = est->P[0][1];
+    est->P[1][1] = clamp_var(m10 * f10 + m11 * f11 + p->q_box * dt);
+}
+
+/**
+ * @brief  标量量测更新，H 为第 idx 个状态的单位行向量
+ */
+static void update_scalar(estimator_t *est, int idx, float innovation, float r)
+{
+    float s = est->P[idx][idx] + r;
+    float k0 = est->P[0][idx] / s;
+    float k1 = est->P[1][idx] / s;
+    est->x[0] += k0 * innovation;
+    est->x[1] += k1 * innovation;
+
+    // P = (I - K H) P，只需用到第 idx 行
+    float pi0 = est->P[idx][0], pi1 = est->P[idx][1];
+    est->P[0][0] = clamp_var(est->P[0][0] - k0 * pi0);
+    est->P[0][1] -= k0 * pi1;
+    est->P[1][1] = clamp_var(est->P[1][1] - k1 * pi1);
+    est->P[1][0] = est->P[0][1];
+}
+
+/**
+ * @brief  融合一次NTC读数
+ * @note   不做新息门限：PTC 自限温区模型误差大，应以实测为准
+ */
+void estimator_update_ptc(estimator_t *est, float measured)
+{
+    update_scalar(est, 0, measured - est->x[0], est->p.r_ptc);
+}
+
+/**
+ * @brief  融合一个箱温样本
+ * @param  measured DHT11读数
+ * @param  age 样本采样时刻距今的时间 (s)，按模型变化率回推到采样时刻再比较
+ * @return 被新息门限拒绝时返回 0
+ * @note   连续被拒说明估计已偏离（如开箱），此时放大箱温方差重新跟随实测
+ */
+int estimator_update_box(estimator_t *est, float measured, float age)
+{
+    float innovation = measured - (est->x[1] - est->dtb_dt * age);
+    float s = est->P[1][1] + est->p.r_box;
+
+    if (innovation * innovation > ESTIMATOR_GATE_SIGMA2 * s)
+    {
+        est->box_rejects++;
+        if (++est->box_reject_run < ESTIMATOR_REJECT_RUN) return 0;
+        est->P[1][1] = clamp_var(innovation * innovation);
+    }
+    est->box_reject_run = 0;
+    update_scalar(est, 1, innovation, est->p.r_box);
+    est->box_updates++;
+    return 1;
+}
@@ -0,0 +1,47 @@
+#ifndef ESTIMATOR_H
+#define ESTIMATOR_H
+
+/*******************************************************************************
+ * 箱温状态估计（二维卡尔曼滤波）
+ *
+ * 状态 x = [PTC温度, 箱内温度]，按与 sim/thermal_plant.h 相同的两节点热模型预测：
+ *   c_ptc * dTp/dt = p_ptc_max * heat - g_ptc_box * (1 + fan_ptc_gain * fan) * (Tp - Tb)
+ *   c_box * dTb/dt = g_ptc_box * (...) * (Tp - Tb) - (g_box_env + g_fan * fan) * (Tb - Te)
+ * 每个控制周期以上一周期的占空比和环境温度预测一步，再用NTC（10 Hz）和
+ * DHT11（1 Hz，1°C 量化）分别做标量量测更新。PTC 自限温等未建模部分由过程噪声吸收。
+ *
+ * 与 control.c 一样不依赖外设，固件与 PC 仿真器共用。
+ ******************************************************************************/
+#include <stdint.h>
+
+typedef struct {
+    float c_ptc;            // PTC+散热片热容 (J/K)
+    float c_box;            // 箱内空气及负载热容 (J/K)
+    float g_ptc_box;        // PTC→箱内 热导 (W/K)
+    float g_box_env;        // 箱体→环境 热导 (W/K)
+    float g_fan;            // 风扇满速时的附加换气热导 (W/K)
+    float fan_ptc_gain;     // 风扇满速时PTC→箱内热导的增益倍数
+    float p_ptc_max;        // PTC满占空比功率 (W)
+    float q_ptc;            // PTC温度过程噪声谱密度 (°C²/s)
+    float q_box;            // 箱温过程噪声谱密度 (°C²/s)
+    float r_ptc;            // NTC量测噪声方差 (°C²)
+    float r_box;            // DHT11量测噪声方差 (°C²)，含 1°C 量化的 1/12
+} estimator_params_t;
+
+typedef struct {
+    estimator_params_t p;
+    float x[2];                 // [Tp, Tb] 估计 (°C)
+    float P[2][2];              // 估计协方差
+    float dtb_dt;               // 模型给出的箱温变化率 (°C/s)，用于对齐延迟样本
+    uint32_t box_updates;       // 已融合的箱温样本数
+    uint32_t box_rejects;       // 因新息过大被拒绝的箱温样本数
+    uint32_t box_reject_run;    // 连续被拒绝的次数
+} estimator_t;
+
+void estimator_default(estimator_params_t *params);
+void estimator_init(estimator_t *est, const estimator_params_t *params, float t_ptc, float t_box);
+void estimator_predict(estimator_t *est, float dt, float heat_duty, float fan_duty, float t_env);
+void estimator_update_ptc(estimator_t *est, float measured);
+int estimator_update_box(estimator_t *est, float measured, float age);
+
+#endif /* ESTIMATOR_H */
@@ -0,0 +1,209 @@
+#include <math.h>
+#include <string.h>
+#include "ident.h"
+
+/*******************************************************************************
+ * 参数定义
+ ******************************************************************************/
+#define IDENT_P_TRACE_MAX       10.0f       // 协方差迹超过该值时暂停遗忘，防止激励不足时发散
+
+/*******************************************************************************
+ * 函数定义
+ ******************************************************************************/
+static void rls_init(ident_rls_t *r, float s0, float s1, float noise, float lambda)
+{
+    memset(r, 0, sizeof(*r));
+    r->theta[0] = 1.0f;
+    r->theta[1] = 1.0f;
+    r->scale[0] = s0;
+    r->scale[1] = s1;
+    r->noise = noise;
+    r->P[0][0] = 1.0f;
+    r->P[1][1] = 1.0f;
+    r->lambda = lambda;
+}
+
+/**
+ * @brief  以先验参数初始化
+ * @note   先验协方差为单位阵，即各参数有 100% 的先验不确定度
+ */
+void ident_init(ident_t *id, const estimator_params_t *prior)
+{
+    memset(id, 0, sizeof(*id));
+    rls_init(&id->ptc, prior->p_ptc_max / prior->c_ptc, prior->g_ptc_box / prior->c_ptc,
+             IDENT_PTC_NOISE, IDENT_PTC_LAMBDA);
+    rls_init(&id->box, prior->g_ptc_box / prior->c_box, prior->g_box_env / prior->c_box,
+             IDENT_BOX_NOISE, IDENT_BOX_LAMBDA);
+    id->win_ptc.t = -1.0f;
+    id->win_box.t = -1.0f;
+}
+
+static void rls_update(ident_rls_t *r, const float phi[2], float y)
+{
+    float inv_noise = 1.0f / r->noise;
+    float x0 = phi[0] * r->scale[0] * inv_noise;
+    float x1 = phi[1] * r->scale[1] * inv_noise;
+    y *= inv_noise;
+    float err = y - (r->theta[0] * x0 + r->theta[1] * x1);
+
+    float px0 = r->P[0][0] * x0 + r->P[0][1] * x1;
+    float px1 = r->P[1][0] * x0 + r->P[1][1] * x1;
+    float denom = r->lambda + x0 * px0 + x1 * px1;
+    float k0 = px0 / denom;
+    float k1 = px1 / denom;
+
+    r->theta[0] += k0 * err;
+    r->theta[1] += k1 * err;
+
+    float forget = (r->P[0][0] + r->P[1][1] > IDENT_P_TRACE_MAX) ? 1.0f : r->lambda;
+    float p00 = (r->P[0][0] - k0 * px0) / forget;
+    float p01 = (r->P[0][1] - k0 * px1) / forget;
+    float p11 = (r->P[1][1] - k1 * px1) / forget;
+    r->P[0][0] = p00;
+    r->P[0][1] = r->P[1][0] = p01;
+    r->P[1][1] = p11;
+
+    // 拟合度统计，与参数使用同一记忆长度
+    float alpha = 1.0f - r->lambda;
+    float dy = y - r->y_mean;
+    r->y_mean += alpha * dy;
+    r->y_var = (1.0f - alpha) * (r->y_var + alpha * dy * dy);
+    r->err_var = (1.0f - alpha) * r->err_var + alpha * err * err;
+    r->samples++;
+}
+
+static float rls_fit(const ident_rls_t *r)
+{
+    if (r->y_var <= 0.0f) return 0.0f;
+    return 1.0f - r->err_var / r->y_var;
+}
+
+/**
+ * @brief  两参数比值 θ0/θ1 的相对标准差（一阶近似）
+ * @note   前馈表只依赖 a/b 与 c/d，热容的不确定性不影响结果，因此以比值判定收敛；
+ *         方程已按假定噪声归一化，P 再乘以实际残差方差 err_var 修正尺度
+ */
+static float rls_ratio_uncertainty(const ident_rls_t *r)
+{
+    if (r->theta[0] <= 0.0f || r->theta[1] <= 0.0f) return 1e6f;
+    float i0 = 1.0f / r->theta[0];
+    float i1 = 1.0f / r->theta[1];
+    float var = r->P[0][0] * i0 * i0 + r->P[1][1] * i1 * i1 - 2.0f * r->P[0][1] * i0 * i1;
+    return sqrtf((var > 0.0f ? var : 0.0f) * r->err_var);
+}
+
+/**
+ * @brief  推进一个回归窗口
+ * @param  y 窗口输出对应的温度（求平均变化率）
+ * @param  phi 本控制周期的回归量
+ */
+static int window_step(ident_window_t *w, ident_rls_t *r, float length, float dt, float y, const float phi[2])
+{
+    if (w->t < 0.0f) {
+        w->t = 0.0f;
+        w->y0 = y;
+        w->phi[0] = 0.0f;
+        w->phi[1] = 0.0f;
+        return 0;
+    }
+    w->phi[0] += phi[0] * dt;
+    w->phi[1] += phi[1] * dt;
+    w->t += dt;
+    if (w->t < length) return 0;
+
+    float inv = 1.0f / w->t;
+    float avg[2] = { w->phi[0] * inv, w->phi[1] * inv };
+    rls_update(r, avg, (y - w->y0) * inv);
+    w->t = 0.0f;
+    w->y0 = y;
+    w->phi[0] = 0.0f;
+    w->phi[1] = 0.0f;
+    return 1;
+}
+
+static void model_update(ident_t *id)
+{
+    ident_model_t *m = &id->model;
+    float a = id->ptc.theta[0] * id->ptc.scale[0];
+    float b = id->ptc.theta[1] * id->ptc.scale[1];
+    float c = id->box.theta[0] * id->box.scale[0];
+    float d = id->box.theta[1] * id->box.scale[1];
+
+    m->samples_ptc = id->ptc.samples;
+    m->samples_box = id->box.samples;
+    m->fit_ptc = rls_fit(&id->ptc);
+    m->fit_box = rls_fit(&id->box);
+    m->unc_ptc = rls_ratio_uncertainty(&id->ptc);
+    m->unc_box = rls_ratio_uncertainty(&id->box);
+    if (a > 0.0f && b > 0.0f) {
+        m->tau_ptc = 1.0f / b;
+        m->k_ptc = a / b;
+    }
+    if (c > 0.0f && d > 0.0f) {
+        m->tau_box = 1.0f / (c + d);
+        m->k_box = c / (c + d);
+    }
+    m->valid = a > 0.0f && b > 0.0f && c > 0.0f && d > 0.0f
+            && m->samples_ptc >= IDENT_PTC_MIN_SAMPLES && m->samples_box >= IDENT_BOX_MIN_SAMPLES
+            && m->unc_ptc <= IDENT_MAX_UNCERTAINTY && m->unc_box <= IDENT_MAX_UNCERTAINTY;
+}
+
+/**
+ * @brief  送入一个控制周期的数据
+ * @param  dt 距上一次调用的时间 (s)
+ * @param  duty 上一周期施加在PTC上的占空比
+ * @param  valid 上一周期继电器处于加热侧；为 0 时丢弃未完成的窗口
+ */
+void ident_update(ident_t *id, float dt, float duty, float t_ptc, float t_box, float t_env, int valid)
+{
+    if (!valid) {
+        id->win_ptc.t = -1.0f;
+        id->win_box.t = -1.0f;
+    } else {
+        // 温度取区间两端的平均，占空比在区间内恒定
+        float tp = 0.5f * (t_ptc + id->last[0]);
+        float tb = 0.5f * (t_box + id->last[1]);
+        float te = 0.5f * (t_env + id->last[2]);
+        float phi_ptc[2] = { duty, tb - tp };
+        float phi_box[2] = { tp - tb, te - tb };
+        int updated = window_step(&id->win_ptc, &id->ptc, IDENT_PTC_WINDOW_S, dt, t_ptc, phi_ptc);
+        updated |= window_step(&id->win_box, &id->box, IDENT_BOX_WINDOW_S, dt, t_box, phi_box);
+        if (updated) model_update(id);
+    }
+    id->last[0] = t_ptc;
+    id->last[1] = t_box;
+    id->last[2] = t_env;
+}
+
+/**
+ * @brief  维持PTC温度 t_ptc 所需的稳态占空比（ff_table）
+ */
+float ident_ff_pwm(const ident_model_t *m, float t_ptc, float t_env)
+{
+    float u = (t_ptc - t_env) * (1.0f - m->k_box) / m->k_ptc;
+    if (u < 0.0f) return 0.0f;
+    if (u > 1.0f) return 1.0f;
+    return u;
+}
+
+/**
+ * @brief  维持箱温 t_box 所需的PTC温度（warming_ff_table）
+ */
+float ident_warming_ptc(const ident_model_t *m, float t_box, float t_env)
+{
+    return t_box + (t_box - t_env) * (1.0f - m->k_box) / m->k_box;
+}
+
+/**
+ * @brief  用辨识结果改写估计器的加热侧模型参数
+ * @note   热容无法单独辨识，以 p_ptc_max 为绝对尺度换算热导与热容；风扇相关参数和噪声参数不变
+ */
+void ident_estimator_params(const ident_model_t *m, estimator_params_t *p)
+{
+    float g_ptc_box = p->p_ptc_max / m->k_ptc;
+    float g_total = g_ptc_box / m->k_box;
+    p->g_ptc_box = g_ptc_box;
+    p->g_box_env = g_total - g_ptc_box;
+    p->c_ptc = m->tau_ptc * g_ptc_box;
+    p->c_box = m->tau_box * g_total;
+}
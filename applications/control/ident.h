@@ -0,0 +1,79 @@
+#ifndef IDENT_H
+#define IDENT_H
+
+/*******************************************************************************
+ * 热模型在线辨识（递推最小二乘）
+ *
+ * 以 estimator.h 的两节点模型为结构，只在继电器处于加热侧（风扇不转）时辨识：
+ *   dTp/dt = a·u - b·(Tp - Tb)          a = p_ptc_max/c_ptc, b = g_ptc_box/c_ptc
+ *   dTb/dt = c·(Tp - Tb) - d·(Tb - Te)  c = g_ptc_box/c_box, d = g_box_env/c_box
+ * 两个子模型各自按固定窗口求平均变化率与回归量的时间平均，送入带遗忘因子的
+ * 二参数 RLS。箱温为 DHT11 实测值，1°C 量化误差在长窗口的平均变化率中被摊薄。
+ * 热容无法单独辨识，但前馈表只依赖参数比值：
+ *   稳态PWM   u  = (Tp - Te)·(1 - k_box)/k_ptc
+ *   保温PTC温度 Tp = Tb + (Tb - Te)·(1 - k_box)/k_box
+ ******************************************************************************/
+#include <stdint.h>
+#include "estimator.h"
+
+#define IDENT_PTC_WINDOW_S      1.0f        // PTC 子模型的回归窗口 (s)
+#define IDENT_BOX_WINDOW_S      60.0f       // 箱温子模型的回归窗口 (s)
+#define IDENT_PTC_NOISE         0.07f       // PTC 窗口平均变化率的噪声标准差 (°C/s)，NTC 噪声 0.05°C
+#define IDENT_BOX_NOISE         0.01f       // 箱温窗口平均变化率的噪声标准差 (°C/s)，DHT11 量化+器件误差
+#define IDENT_PTC_LAMBDA        0.999f      // 遗忘因子，记忆约 1000 个窗口（17 分钟）
+#define IDENT_BOX_LAMBDA        0.995f      // 记忆约 200 个窗口（3.3 小时）
+#define IDENT_PTC_MIN_SAMPLES   300         // 给出有效模型前需要的最少窗口数
+#define IDENT_BOX_MIN_SAMPLES   30
+#define IDENT_MAX_UNCERTAINTY   0.1f        // 参数比值的相对标准差上限，超过时不用于生成前馈表
+
+/* 二参数 RLS：参数以先验值归一化（初值为 1），方程两边除以输出噪声，P 即参数的相对方差 */
+typedef struct {
+    float theta[2];             // 归一化参数
+    float scale[2];             // 先验参数值
+    float noise;                // 输出噪声标准差
+    float P[2][2];
+    float lambda;
+    float y_mean;               // 输出的指数加权均值
+    float y_var;                // 输出的指数加权方差
+    float err_var;              // 先验残差的指数加权方差
+    uint32_t samples;
+} ident_rls_t;
+
+/* 回归窗口：累积回归量的时间积分 */
+typedef struct {
+    float t;                    // 已累积时间 (s)，<0 表示窗口未开始
+    float y0;                   // 窗口起点的温度
+    float phi[2];
+} ident_window_t;
+
+/* 辨识结果 */
+typedef struct {
+    float tau_ptc;              // PTC 时间常数 c_ptc/g_ptc_box (s)
+    float k_ptc;                // 满占空比时PTC高于箱温的稳态温升 p_ptc_max/g_ptc_box (°C)
+    float tau_box;              // PTC 温度固定时箱温的时间常数 c_box/(g_ptc_box+g_box_env) (s)
+    float k_box;                // 箱温跟随PTC温度的比例 g_ptc_box/(g_ptc_box+g_box_env)
+    float fit_ptc;              // 拟合度 1 - var(残差)/var(输出)
+    float fit_box;
+    float unc_ptc;              // 参数比值（k_ptc、k_box 的来源）的相对标准差
+    float unc_box;
+    uint32_t samples_ptc;
+    uint32_t samples_box;
+    uint8_t valid;              // 样本数、参数符号和不确定度均满足要求
+} ident_model_t;
+
+typedef struct {
+    ident_rls_t ptc;
+    ident_rls_t box;
+    ident_window_t win_ptc;
+    ident_window_t win_box;
+    float last[3];              // 上一次调用时的 [Tp, Tb, Te]
+    ident_model_t model;        // 每完成一个窗口更新一次
+} ident_t;
+
+void ident_init(ident_t *id, const estimator_params_t *prior);
+void ident_update(ident_t *id, float dt, float duty, float t_ptc, float t_box, float t_env, int valid);
+float ident_ff_pwm(const ident_model_t *m, float t_ptc, float t_env);
+float ident_warming_ptc(const ident_model_t *m, float t_box, float t_env);
+void ident_estimator_params(const ident_model_t *m, estimator_params_t *p);
+
+#endif /* IDENT_H */
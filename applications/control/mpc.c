@@ -0,0 +1,243 @@
+#include <string.h>
+#include "mpc.h"
+
+/*******************************************************************************
+ * 参数定义
+ ******************************************************************************/
+#define N   MPC_HORIZON
+
+/* 线性化模型 x' = A x + B u + c，A、c 与执行器无关（风扇作用已并入 B） */
+typedef struct {
+    float a00, a01, a10, a11;
+    float c1;
+    float b0, b1;
+} mpc_model_t;
+
+/*******************************************************************************
+ * 函数定义
+ ******************************************************************************/
+void mpc_default_weights(mpc_weights_t *w)
+{
+    w->q_box = 1.0f;
+    w->r_duty = 0.5f;
+    w->d_duty = 2.0f;
+    w->q_ptc = 10.0f;
+    w->switch_cost = 20.0f;
+}
+
+void mpc_init(mpc_t *mpc, const mpc_weights_t *w, mpc_actuator_t actuator)
+{
+    memset(mpc, 0, sizeof(*mpc));
+    mpc->w = *w;
+    mpc->actuator = actuator;
+    mpc->since_switch = MPC_MIN_DWELL_S;
+}
+
+static void model_build(mpc_model_t *m, const estimator_params_t *p, const float x0[2],
+                        float t_env, mpc_actuator_t act)
+{
+    m->a00 = -p->g_ptc_box / p->c_ptc;
+    m->a01 = p->g_ptc_box / p->c_ptc;
+    m->a10 = p->g_ptc_box / p->c_box;
+    m->a11 = -(p->g_ptc_box + p->g_box_env) / p->c_box;
+    m->c1 = p->g_box_env * t_env / p->c_box;
+    if (act == MPC_ACT_HEAT)
+    {
+        m->b0 = p->p_ptc_max / p->c_ptc;
+        m->b1 = 0.0f;
+    }
+    else
+    {
+        // 风扇满速时的附加换热，在当前温度处线性化
+        float q_pb = p->g_ptc_box * p->fan_ptc_gain * (x0[0] - x0[1]);
+        m->b0 = -q_pb / p->c_ptc;
+        m->b1 = (q_pb - p->g_fan * (x0[1] - t_env)) / p->c_box;
+    }
+}
+
+/**
+ * @brief  以恒定输入积分一个时段
+ * @param  affine 为 0 时只积分齐次部分（用于求脉冲响应）
+ */
+static void model_block(const mpc_model_t *m, float x[2], float u, int affine)
+{
+    const float h = MPC_BLOCK_S / MPC_SUBSTEPS;
+    float c1 = affine ? m->c1 : 0.0f;
+
+    for (int s = 0; s < MPC_SUBSTEPS; s++)
+    {
+        float d0 = m->a00 * x[0] + m->a01 * x[1] + m->b0 * u;
+        float d1 = m->a10 * x[0] + m->a11 * x[1] + m->b1 * u + c1;
+        x[0] += d0 * h;
+        x[1] += d1 * h;
+    }
+}
+
+/**
+ * @brief  对一种执行器求解盒约束 QP
+ * @param  ptc_lim PTC 温度软约束
+ * @param  plan 输入为热启动序列，输出为最优序列
+ * @return 最优代价
+ */
+static float mpc_solve(const mpc_weights_t *w, const mpc_model_t *m, const float x0[2], float target,
+                       float ptc_lim, float u_prev, float u_ss, float lo, float hi, float plan[N])
+{
+    static float H[N][N];       // 1 KB，只由PID线程调用，不占线程栈
+    float g[N], gp[N], e[N], ep[N], f[N];
+    float x[2];
+
+    // 零输入响应：箱温误差与PTC相对软约束的余量
+    x[0] = x0[0];
+    x[1] = x0[1];
+    for (int k = 0; k < N; k++)
+    {
+        model_block(m, x, 0.0f, 1);
+        e[k] = x[1] - target;
+        ep[k] = x[0] - ptc_lim;
+    }
+
+    // 第一个时段施加单位输入的响应；模型时不变，G[k][j] = g[k-j]
+    x[0] = 0.0f;
+    x[1] = 0.0f;
+    model_block(m, x, 1.0f, 0);
+    g[0] = x[1];
+    gp[0] = x[0];
+    float gp_sum = gp[0] < 0.0f ? -gp[0] : gp[0];
+    for (int k = 1; k < N; k++)
+    {
+        model_block(m, x, 0.0f, 0);
+        g[k] = x[1];
+        gp[k] = x[0];
+        gp_sum += gp[k] < 0.0f ? -gp[k] : gp[k];
+    }
+
+    // 二次部分 H = q G'G + r I + d D'D，f = q G'e - r u_ss - d u_prev e_0
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = i; j < N; j++)
+        {
+            float sum = 0.0f;
+            for (int k = j; k < N; k++) sum += g[k - i] * g[k - j];
+            H[i][j] = H[j][i] = w->q_box * sum;
+        }
+        float sum = 0.0f;
+        for (int k = i; k < N; k++) sum += g[k - i] * e[k];
+        f[i] = w->q_box * sum - w->r_duty * u_ss;
+        H[i][i] += w->r_duty + w->d_duty * (i == N - 1 ? 1.0f : 2.0f);
+        if (i > 0) H[i][i - 1] -= w->d_duty;
+        if (i < N - 1) H[i][i + 1] -= w->d_duty;
+    }
+    f[0] -= w->d_duty * u_prev;
+
+    // 步长取梯度 Lipschitz 常数上界的倒数：H 的 Gershgorin 界加上软约束项的 ‖Gp‖₁‖Gp‖∞
+    float lipschitz = 0.0f;
+    for (int i = 0; i < N; i++)
+    {
+        float row = 0.0f;
+        for (int j = 0; j < N; j++) row += H[i][j] < 0.0f ? -H[i][j] : H[i][j];
+        if (row > lipschitz) lipschitz = row;
+    }
+    float step = 1.0f / (lipschitz + w->q_ptc * gp_sum * gp_sum);
+
+    // 加速投影梯度，固定迭代次数
+    float y[N], prev[N], over[N];
+    for (int i = 0; i < N; i++)
+    {
+        if (plan[i] < lo) plan[i] = lo;
+        if (plan[i] > hi) plan[i] = hi;
+        y[i] = prev[i] = plan[i];
+    }
+    for (int it = 0; it < MPC_ITERATIONS; it++)
+    {
+        float momentum = (float)it / (float)(it + 3);
+        for (int k = 0; k < N; k++)
+        {
+            float tp = ep[k];
+            for (int j = 0; j <= k; j++) tp += gp[k - j] * y[j];
+            over[k] = tp > 0.0f ? tp : 0.0f;
+        }
+        for (int i = 0; i < N; i++)
+        {
+            float grad = f[i];
+            for (int j = 0; j < N; j++) grad += H[i][j] * y[j];
+            for (int k = i; k < N; k++) grad += w->q_ptc * gp[k - i] * over[k];
+            float u = y[i] - step * grad;
+            plan[i] = (u < lo) ? lo : (u > hi) ? hi : u;
+        }
+        for (int i = 0; i < N; i++)
+        {
+            y[i] = plan[i] + momentum * (plan[i] - prev[i]);
+            prev[i] = plan[i];
+        }
+    }
+
+    // 代价 = Σ q·(e + G u)² + r·(u - u_ss)² + d·Δu² + p·max(0, ep + Gp u)²
+    float cost = 0.0f;
+    for (int k = 0; k < N; k++)
+    {
+        float tb = e[k];
+        float tp = ep[k];
+        for (int j = 0; j <= k; j++)
+        {
+            tb += g[k - j] * plan[j];
+            tp += gp[k - j] * plan[j];
+        }
+        float du = plan[k] - (k == 0 ? u_prev : plan[k - 1]);
+        float dr = plan[k] - u_ss;
+        cost += w->q_box * tb * tb + w->r_duty * dr * dr + w->d_duty * du * du;
+        if (tp > 0.0f) cost += w->q_ptc * tp * tp;
+    }
+    return cost;
+}
+
+/**
+ * @brief  执行一个控制周期的 MPC
+ * @param  est 当前状态估计（初值与模型参数）
+ * @param  dt 控制周期 (s)
+ * @param  ptc_max PTC 过热保护阈值
+ * @param  heat_max PTC 占空比上限
+ * @param  fan_min / fan_max 风扇占空比范围
+ * @return 本周期应施加在 mpc->actuator 上的占空比
+ */
+float mpc_step(mpc_t *mpc, const estimator_t *est, float target, float t_env, float dt,
+               float ptc_max, float heat_max, float fan_min, float fan_max)
+{
+    const estimator_params_t *p = &est->p;
+    const float ptc_lim = ptc_max - MPC_PTC_MARGIN;
+    mpc_model_t model;
+
+    // 维持目标温度所需的PTC占空比（稳态时PTC放热等于箱体散热）
+    float u_ss_heat = p->g_box_env * (target - t_env) / p->p_ptc_max;
+    if (u_ss_heat < 0.0f) u_ss_heat = 0.0f;
+    if (u_ss_heat > heat_max) u_ss_heat = heat_max;
+
+    for (int act = MPC_ACT_HEAT; act <= MPC_ACT_FAN; act++)
+    {
+        float *plan = mpc->plan[act];
+        float u_prev = (act == (int)mpc->actuator) ? mpc->duty : 0.0f;
+
+        // 热启动：上一周期的最优序列（时段长度远大于控制周期，不做平移）
+        model_build(&model, p, est->x, t_env, (mpc_actuator_t)act);
+        if (act == MPC_ACT_HEAT)
+            mpc->cost[act] = mpc_solve(&mpc->w, &model, est->x, target, ptc_lim, u_prev, u_ss_heat, 0.0f, heat_max, plan);
+        else
+            mpc->cost[act] = mpc_solve(&mpc->w, &model, est->x, target, ptc_lim, u_prev, fan_min, fan_min, fan_max, plan);
+    }
+
+    // 切换继电器需要足够的代价优势和最短保持时间，避免在目标附近来回切换
+    mpc->since_switch += dt;
+    mpc_actuator_t other = (mpc->actuator == MPC_ACT_HEAT) ? MPC_ACT_FAN : MPC_ACT_HEAT;
+    if (mpc->since_switch >= MPC_MIN_DWELL_S && mpc->cost[other] + mpc->w.switch_cost < mpc->cost[mpc->actuator])
+    {
+        mpc->actuator = other;
+        mpc->since_switch = 0.0f;
+        mpc->switches++;
+    }
+    mpc->duty = mpc->plan[mpc->actuator][0];
+
+    float x[2] = { est->x[0], est->x[1] };
+    model_build(&model, p, est->x, t_env, mpc->actuator);
+    model_block(&model, x, mpc->duty, 1);
+    mpc->ptc_pred = x[0];
+    return mpc->duty;
+}
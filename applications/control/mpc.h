@@ -0,0 +1,57 @@
+#ifndef MPC_H
+#define MPC_H
+
+/*******************************************************************************
+ * 模型预测控制（可在运行时替代级联PID与三态状态机）
+ *
+ * 以 estimator.h 的两节点热模型和当前状态估计为初值，预测未来 MPC_HORIZON 个
+ * 时段（每段 MPC_BLOCK_S 秒、占空比分段保持）的箱温：
+ *   min  Σ q·(Tb_k - target)² + r·(u_k - u_ss)² + d·(u_k - u_{k-1})² + p·max(0, Tp_k - Tp_lim)²
+ *   s.t. lo ≤ u_k ≤ hi
+ * 其中 u_ss 为模型给出的维持目标温度所需的稳态占空比（风扇取下限），最后一项是
+ * PTC 温度的软约束（Tp_lim 比过热保护阈值低 MPC_PTC_MARGIN）。
+ * PTC 和风扇共用一路 PWM、由继电器切换，因此对两种执行器各解一次带盒约束的 QP，
+ * 代价优势超过 switch_cost 且距上次切换超过 MPC_MIN_DWELL_S 时才切换继电器。
+ * 风扇对换热的作用是双线性的，按当前状态线性化。QP 用固定迭代次数的
+ * 加速投影梯度法求解，每周期计算量恒定。
+ ******************************************************************************/
+#include <stdint.h>
+#include "estimator.h"
+
+#define MPC_HORIZON         16          // 预测时段数
+#define MPC_BLOCK_S         30.0f       // 每个时段的长度 (s)，预测 8 分钟
+#define MPC_SUBSTEPS        3           // 每个时段内的欧拉积分步数
+#define MPC_ITERATIONS      40          // 投影梯度迭代次数
+#define MPC_MIN_DWELL_S     60.0f       // 继电器两次切换的最短间隔 (s)
+#define MPC_PTC_MARGIN      10.0f       // PTC 软约束相对过热阈值的余量 (°C)
+
+typedef enum {
+    MPC_ACT_HEAT = 0,           // PWM 驱动 PTC
+    MPC_ACT_FAN                 // PWM 驱动风扇
+} mpc_actuator_t;
+
+typedef struct {
+    float q_box;                // 箱温误差权重
+    float r_duty;               // 占空比权重
+    float d_duty;               // 占空比变化权重
+    float q_ptc;                // PTC 超出软约束的权重
+    float switch_cost;          // 切换执行器所需的最小代价优势
+} mpc_weights_t;
+
+typedef struct {
+    mpc_weights_t w;
+    mpc_actuator_t actuator;    // 当前选用的执行器
+    float duty;                 // 本周期输出占空比
+    float plan[2][MPC_HORIZON]; // 两种执行器上一周期的最优序列，用于热启动
+    float cost[2];              // 两种执行器的最优代价
+    float ptc_pred;             // 第一个时段末的预测PTC温度
+    float since_switch;         // 距上次切换的时间 (s)
+    uint32_t switches;          // 执行器切换次数
+} mpc_t;
+
+void mpc_default_weights(mpc_weights_t *w);
+void mpc_init(mpc_t *mpc, const mpc_weights_t *w, mpc_actuator_t actuator);
+float mpc_step(mpc_t *mpc, const estimator_t *est, float target, float t_env, float dt,
+               float ptc_max, float heat_max, float fan_min, float fan_max);
+
+#endif /* MPC_H */
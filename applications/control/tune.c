@@ -0,0 +1,282 @@
+#include <stdlib.h>
+#include <string.h>
+#include "tune.h"
+
+/**
+ * @brief  解析 "temp:value,temp:value,..." 形式的前馈点列表
+ * @param  table apply 非零时把各点写入该表（已有温度点改值，否则按顺序插入）
+ * @return 点数；格式有误或表已满时返回 -1
+ */
+static int ff_parse_points(const char *list, ff_table_t *table, int apply)
+{
+    const char *s = list;
+    char *end;
+    int n = 0;
+
+    while (*s != '\0') {
+        float temp = strtod(s, &end);
+        if (end == s || *end != ':') return -1;
+        s = end + 1;
+        float value = strtod(s, &end);
+        if (end == s || (*end != ',' && *end != '\0')) return -1;
+        s = (*end == ',') ? end + 1 : end;
+        if (apply && ff_table_set(table, temp, value) < 0) return -1;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief  打印参数集中的两张前馈表
+ */
+void tune_print_ff(const control_params_t *p)
+{
+    CONTROL_LOG("Feedforward (0-ptc), %d/%d points:\n", p->ff.count, CONTROL_FF_CAPACITY);
+    for (int i = 0; i < p->ff.count; i++)
+        CONTROL_LOG("  ff    %6.1f C -> %.3f\n", p->ff.points[i].temp, p->ff.points[i].value);
+    CONTROL_LOG("Warming feedforward (1-warmt), %d/%d points:\n", p->warming_ff.count, CONTROL_FF_CAPACITY);
+    for (int i = 0; i < p->warming_ff.count; i++)
+        CONTROL_LOG("  warmt %6.1f C -> %.1f C\n", p->warming_ff.points[i].temp, p->warming_ff.points[i].value);
+}
+
+/**
+ * @brief  检查参数集能否提交
+ * @return 有前馈表为空（clear 之后尚未 load）时返回 TUNE_ERROR
+ */
+int tune_check(const control_params_t *p)
+{
+    if (p->ff.count == 0 || p->warming_ff.count == 0) {
+        CONTROL_LOG("Error: %s table is empty, load points before committing.\n",
+                    p->ff.count == 0 ? "Feedforward" : "Warming feedforward");
+        return TUNE_ERROR;
+    }
+    return TUNE_OK;
+}
+
+/**
+ * @brief  在参数集 p 上修改一个参数
+ * @return 参数有误或找不到对应条目时返回 TUNE_ERROR
+ */
+int tune_edit(control_params_t *p, int argc, char **argv)
+{
+    const char *cmd = argv[1];
+
+    if (strcmp(cmd, "target") == 0) {
+        if (argc != 3) { CONTROL_LOG("Usage: tune target <value>\n"); return TUNE_ERROR; }
+        p->target_temperature = atof(argv[2]);
+        CONTROL_LOG("Target temperature set to %.2f C\n", p->target_temperature);
+    }
+    else if (strcmp(cmd, "hys") == 0) {
+        if (argc != 3) { CONTROL_LOG("Usage: tune hys <value>\n"); return TUNE_ERROR; }
+        p->hysteresis_band = atof(argv[2]);
+        CONTROL_LOG("Hysteresis band set to +/- %.2f C\n", p->hysteresis_band);
+    }
+    else if (strcmp(cmd, "warmbias") == 0) {
+        if (argc != 3) { CONTROL_LOG("Usage: tune warmbias <value>\n"); return TUNE_ERROR; }
+        p->warming_bias = atof(argv[2]);
+        CONTROL_LOG("Warming bias temperature set to %.2f C\n", p->warming_bias);
+    }
+    else if (strcmp(cmd, "heatbias") == 0) {
+        if (argc != 3) { CONTROL_LOG("Usage: tune heatbias <value>\n"); return TUNE_ERROR; }
+        p->heating_bias = atof(argv[2]);
+        CONTROL_LOG("Heating bias temperature set to %.2f C\n", p->heating_bias);
+    }
+    else if (strcmp(cmd, "ff") == 0) {
+        // tune ff <0|1> <temp> <value> / del <0|1> <temp> / clear <0|1> / load <0|1> <temp:value,...> ...
+        const char *op = (argc >= 3 && (strcmp(argv[2], "del") == 0 || strcmp(argv[2], "clear") == 0
+                                        || strcmp(argv[2], "load") == 0)) ? argv[2] : NULL;
+        int type_arg = op ? 3 : 2;
+        if (argc <= type_arg) {
+            CONTROL_LOG("Usage: tune ff <0-ptc/1-warmt> <temp> <value> | del <0|1> <temp> | clear <0|1>\n");
+            CONTROL_LOG("       tune ff load <0|1> <temp:value>[,<temp:value>...] ...\n");
+            return TUNE_ERROR;
+        }
+        int table_type = atoi(argv[type_arg]);
+        if (table_type != 0 && table_type != 1) {
+            CONTROL_LOG("Error: Unknown feedforward table type '%s'. Use 0 for ptc, 1 for warmt.\n", argv[type_arg]);
+            return TUNE_ERROR;
+        }
+        ff_table_t *t = table_type ? &p->warming_ff : &p->ff;
+        const char *name = table_type ? "Warming feedforward" : "Feedforward";
+
+        if (op == NULL) {
+            if (argc != 5) { CONTROL_LOG("Usage: tune ff <0-ptc/1-warmt> <temp> <value>\n"); return TUNE_ERROR; }
+            float temp = atof(argv[3]);
+            float value = atof(argv[4]);
+            if (ff_table_set(t, temp, value) < 0) {
+                CONTROL_LOG("Error: %s table is full (%d points).\n", name, CONTROL_FF_CAPACITY);
+                return TUNE_ERROR;
+            }
+            CONTROL_LOG("%s for %.2f C set to %.2f (%d points)\n", name, temp, value, t->count);
+        } else if (op[0] == 'd') {
+            if (argc != 5) { CONTROL_LOG("Usage: tune ff del <0|1> <temp>\n"); return TUNE_ERROR; }
+            float temp = atof(argv[4]);
+            if (ff_table_remove(t, temp) != 0) {
+                CONTROL_LOG("Error: No %s point at %.2f C.\n", table_type ? "warming feedforward" : "feedforward", temp);
+                return TUNE_ERROR;
+            }
+            CONTROL_LOG("%s point %.2f C removed (%d points)\n", name, temp, t->count);
+        } else if (op[0] == 'c') {
+            if (argc != 4) { CONTROL_LOG("Usage: tune ff clear <0|1>\n"); return TUNE_ERROR; }
+            t->count = 0;
+            CONTROL_LOG("%s table cleared, load new points before commit\n", name);
+        } else {
+            // 先检查全部参数，格式有误时表不变；每个参数可含多个以逗号分隔的点，尽量塞满一行命令
+            int total = 0;
+            for (int i = 4; i < argc; i++) {
+                int n = ff_parse_points(argv[i], NULL, 0);
+                if (n < 0) { CONTROL_LOG("Error: Bad point list '%s', expected <temp:value>[,...].\n", argv[i]); return TUNE_ERROR; }
+                total += n;
+            }
+            if (total == 0) { CONTROL_LOG("Usage: tune ff load <0|1> <temp:value>[,<temp:value>...] ...\n"); return TUNE_ERROR; }
+            for (int i = 4; i < argc; i++) {
+                if (ff_parse_points(argv[i], t, 1) < 0) {
+                    CONTROL_LOG("Error: %s table is full (%d points).\n", name, CONTROL_FF_CAPACITY);
+                    return TUNE_ERROR;
+                }
+            }
+            CONTROL_LOG("%s: %d points loaded (%d points)\n", name, total, t->count);
+        }
+    }
+    else if (strcmp(cmd, "sched") == 0) {
+        // tune sched <temp> <box|heat|cool> <kp> <ki> [kd] / tune sched del <temp> / tune sched clear
+        if (argc == 3 && strcmp(argv[2], "clear") == 0) {
+            p->num_sched = 0;
+            CONTROL_LOG("Gain schedule cleared, using fixed gains\n");
+            return TUNE_OK;
+        }
+        if (argc == 4 && strcmp(argv[2], "del") == 0) {
+            float temp = atof(argv[3]);
+            if (gain_sched_remove(p, temp) != 0) {
+                CONTROL_LOG("Error: No gain schedule entry near %.2f C.\n", temp);
+                return TUNE_ERROR;
+            }
+            CONTROL_LOG("Gain schedule entry %.2f C removed\n", temp);
+            return TUNE_OK;
+        }
+        if (argc != 6 && argc != 7) {
+            CONTROL_LOG("Usage: tune sched <temp> <box|heat|cool> <kp> <ki> [kd] | del <temp> | clear\n");
+            return TUNE_ERROR;
+        }
+        const char *which = argv[3];
+        if (strcmp(which, "box") != 0 && strcmp(which, "heat") != 0 && strcmp(which, "cool") != 0) {
+            CONTROL_LOG("Error: Unknown controller '%s'. Use box, heat or cool.\n", which);
+            return TUNE_ERROR;
+        }
+        float temp = atof(argv[2]);
+        int index = gain_sched_upsert(p, temp);
+        if (index < 0) {
+            CONTROL_LOG("Error: Gain schedule is full (%d entries).\n", CONTROL_SCHED_ENTRIES);
+            return TUNE_ERROR;
+        }
+        gain_sched_entry_t *e = &p->sched[index];
+        pid_gains_t *g = (which[0] == 'b') ? &e->box : (which[0] == 'h') ? &e->heat : &e->cool;
+        g->kp = atof(argv[4]);
+        g->ki = atof(argv[5]);
+        if (argc == 7) g->kd = atof(argv[6]);
+        CONTROL_LOG("Gain schedule %.2f C %s set to Kp=%.3f, Ki=%.3f, Kd=%.3f (%d entries)\n",
+                    e->target_temp, which, g->kp, g->ki, g->kd, p->num_sched);
+    }
+    else if (strcmp(cmd, "mode") == 0) {
+        if (argc != 3) { CONTROL_LOG("Usage: tune mode <pid|mpc>\n"); return TUNE_ERROR; }
+        if (strcmp(argv[2], "pid") == 0) p->mode = CONTROL_MODE_PID;
+        else if (strcmp(argv[2], "mpc") == 0) p->mode = CONTROL_MODE_MPC;
+        else { CONTROL_LOG("Error: Unknown mode '%s'. Use pid or mpc.\n", argv[2]); return TUNE_ERROR; }
+        CONTROL_LOG("Control mode set to %s\n", argv[2]);
+    }
+    else if (strcmp(cmd, "box") == 0) {
+        if (argc != 4) { CONTROL_LOG("Usage: tune box <kp|ki|kd> <value>\n"); return TUNE_ERROR; }
+        const char *param = argv[2];
+        float value = atof(argv[3]);
+        if (strcmp(param, "kp") == 0) p->box.kp = value;
+        else if (strcmp(param, "ki") == 0) p->box.ki = value;
+        else if (strcmp(param, "kd") == 0) p->box.kd = value;
+        else { CONTROL_LOG("Error: Unknown box param '%s'. Use kp, ki, or kd.\n", param); return TUNE_ERROR; }
+        CONTROL_LOG("Box PID '%s' set to %f\n", param, value);
+    }
+    else if (strcmp(cmd, "heat") == 0) {
+        if (argc != 4) { CONTROL_LOG("Usage: tune heat <kp|ki|kd> <value>\n"); return TUNE_ERROR; }
+        const char *param = argv[2];
+        float value = atof(argv[3]);
+        if (strcmp(param, "kp") == 0) p->heat.kp = value;
+        else if (strcmp(param, "ki") == 0) p->heat.ki = value;
+        else if (strcmp(param, "kd") == 0) p->heat.kd = value;
+        else { CONTROL_LOG("Error: Unknown heat param '%s'. Use kp, ki, or kd.\n", param); return TUNE_ERROR; }
+        CONTROL_LOG("Heat PID '%s' set to %f\n", param, value);
+    }
+    else if (strcmp(cmd, "cool") == 0) {
+        if (argc != 4) { CONTROL_LOG("Usage: tune cool <kp|ki> <value>\n"); return TUNE_ERROR; }
+        const char *param = argv[2];
+        float value = atof(argv[3]);
+        if (strcmp(param, "kp") == 0) p->cool.kp = value;
+        else if (strcmp(param, "ki") == 0) p->cool.ki = value;
+        else { CONTROL_LOG("Error: Unknown cool param '%s'. Use kp or ki.\n", param); return TUNE_ERROR; }
+        CONTROL_LOG("Cool PI '%s' set to %f\n", param, value);
+    }
+    else {
+        CONTROL_LOG("Error: Unknown command '%s'\n", cmd);
+        return TUNE_ERROR;
+    }
+
+    if (p->num_sched > 0 && (strcmp(cmd, "box") == 0 || strcmp(cmd, "heat") == 0 || strcmp(cmd, "cool") == 0))
+        CONTROL_LOG("Note: Gain schedule active, fixed gains apply after 'tune sched clear'.\n");
+    return TUNE_OK;
+}
+
+/**
+ * @brief  执行一条 tune 命令（调用方负责互斥，固件中为 tune_lock）
+ * @param  caller 调用方标识，只与 s->owner 比较，用于区分事务的归属
+ * @note   事务之外每条命令立即提交；begin 之后的修改只写入 s->staged，
+ *         commit 时整组提交，控制线程在下一个控制周期开始时一次换入
+ * @return TUNE_OK；参数有误返回 TUNE_ERROR，事务被其他调用方持有时返回 TUNE_BUSY
+ */
+int tune_session_apply(tune_session_t *s, const void *caller, int argc, char **argv)
+{
+    if (argc < 2) return TUNE_ERROR;
+
+    const char *cmd = argv[1];
+
+    if (strcmp(cmd, "begin") == 0) {
+        if (s->owner != NULL && s->owner != caller) {
+            CONTROL_LOG("Error: Another tune transaction is in progress.\n");
+            return TUNE_BUSY;
+        }
+        control_params_get(&s->staged);   // 重复 begin 时丢弃已暂存的修改
+        s->owner = caller;
+        CONTROL_LOG("Tune transaction started.\n");
+        return TUNE_OK;
+    }
+    if (strcmp(cmd, "commit") == 0 || strcmp(cmd, "abort") == 0) {
+        if (s->owner != caller) {
+            CONTROL_LOG("Error: No tune transaction in progress.\n");
+            return TUNE_ERROR;
+        }
+        if (cmd[0] == 'a') {
+            CONTROL_LOG("Tune transaction aborted.\n");
+        } else {
+            if (tune_check(&s->staged) != TUNE_OK) return TUNE_ERROR;   // 事务保持打开，可继续修改或 abort
+            control_params_commit(&s->staged);
+            CONTROL_LOG("Tune transaction committed.\n");
+        }
+        s->owner = NULL;
+        return TUNE_OK;
+    }
+    if (strcmp(cmd, "set") == 0) {
+        // tune set <param...>：只允许在事务中使用
+        if (s->owner != caller || argc < 3) {
+            CONTROL_LOG("Usage: tune begin / tune set <param...> / tune commit\n");
+            return TUNE_ERROR;
+        }
+        return tune_edit(&s->staged, argc - 1, argv + 1);
+    }
+
+    if (s->owner == caller) return tune_edit(&s->staged, argc, argv);
+    if (s->owner != NULL) {
+        CONTROL_LOG("Error: Another tune transaction is in progress.\n");
+        return TUNE_BUSY;
+    }
+    control_params_get(&s->scratch);
+    if (tune_edit(&s->scratch, argc, argv) != TUNE_OK || tune_check(&s->scratch) != TUNE_OK) return TUNE_ERROR;
+    control_params_commit(&s->scratch);
+    return TUNE_OK;
+}
@@ -0,0 +1,29 @@
+#ifndef TUNE_H
+#define TUNE_H
+
+/*******************************************************************************
+ * tune 命令：参数编辑与调参事务
+ *
+ * 与硬件无关，固件 (main.c) 与 PC 端板卡仿真器 (sim/board_emu.c) 共用，
+ * 同一条 tune 命令在两边的解析、校验与提交完全一致。
+ * 本模块不加锁，调用方负责串行化（固件中为 tune_lock）。
+ ******************************************************************************/
+#include "control.h"
+
+#define TUNE_OK         0
+#define TUNE_ERROR      (-1)
+#define TUNE_BUSY       (-2)        // 事务被另一个调用方持有
+
+/* 调参会话 */
+typedef struct {
+    const void *owner;              // 打开事务的调用方，NULL 表示没有事务
+    control_params_t staged;        // 事务中暂存的参数集
+    control_params_t scratch;       // 单条命令的参数集副本，前馈表较大，不放在命令线程栈上
+} tune_session_t;
+
+int tune_session_apply(tune_session_t *s, const void *caller, int argc, char **argv);
+int tune_edit(control_params_t *p, int argc, char **argv);
+int tune_check(const control_params_t *p);
+void tune_print_ff(const control_params_t *p);
+
+#endif /* TUNE_H */
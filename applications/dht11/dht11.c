@@ -0,0 +1,137 @@
+#include <rtdevice.h>
+#include "board.h"
+#include "dht11.h"
+
+/*******************************************************************************
+ * 参数定义
+ ******************************************************************************/
+#define DHT11_EDGES             42      // 应答 1 个 + 40 位各 1 个 + 结束 1 个
+#define DHT11_MAX_EDGES         48      // 多留几个，容纳释放总线时的毛刺
+
+static rt_base_t dht11_pin = -1;
+static rt_thread_t dht11_thread = RT_NULL;
+static volatile rt_uint32_t edge_cycles[DHT11_MAX_EDGES];
+static volatile rt_uint8_t edge_count = 0;
+static dht11_reading_t dht11_cache;
+static rt_bool_t dht11_valid = RT_FALSE;
+
+/*******************************************************************************
+ * 函数定义
+ ******************************************************************************/
+static void dht11_edge_isr(void *args)
+{
+    rt_uint32_t now = DWT->CYCCNT;
+    if (edge_count < DHT11_MAX_EDGES) edge_cycles[edge_count++] = now;
+}
+
+/**
+ * @brief  按下降沿间隔解码一帧
+ * @note   第 k 位的时长为第 k+1 与第 k+2 个下降沿之间的间隔（50 us 低电平 + 高电平），
+ *         前面多出的毛刺沿丢弃，只取最后 DHT11_EDGES 个
+ */
+static rt_err_t dht11_decode(rt_uint8_t count, rt_uint8_t data[5])
+{
+    if (count < DHT11_EDGES) return -RT_ETIMEOUT;
+
+    const volatile rt_uint32_t *edge = &edge_cycles[count - DHT11_EDGES];
+    rt_uint32_t threshold = SystemCoreClock / 1000000U * DHT11_BIT_THRESHOLD_US;
+
+    rt_memset(data, 0, 5);
+    for (int k = 0; k < 40; k++)
+    {
+        if (edge[k + 2] - edge[k + 1] > threshold)
+            data[k / 8] |= 0x80 >> (k % 8);
+    }
+    if ((rt_uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4]) return -RT_ERROR;
+    return RT_EOK;
+}
+
+static void dht11_entry(void *parameter)
+{
+    rt_uint8_t data[5];
+
+    while (1)
+    {
+        // 起始信号：拉低 ≥18 ms 后释放，期间线程睡眠
+        rt_pin_mode(dht11_pin, PIN_MODE_OUTPUT);
+        rt_pin_write(dht11_pin, PIN_LOW);
+        rt_thread_mdelay(DHT11_START_LOW_MS);
+
+        edge_count = 0;
+        rt_pin_mode(dht11_pin, PIN_MODE_INPUT_PULLUP);
+        rt_pin_irq_enable(dht11_pin, PIN_IRQ_ENABLE);
+        rt_thread_mdelay(DHT11_FRAME_MS);
+        rt_pin_irq_enable(dht11_pin, PIN_IRQ_DISABLE);
+
+        rt_err_t result = dht11_decode(edge_count, data);
+        rt_enter_critical();
+        if (result == RT_EOK)
+        {
+            // DHT11 小数字节为 0.1 单位，温度小数字节最高位为负号
+            float temp = data[2] + (data[3] & 0x7F) * 0.1f;
+            dht11_cache.temperature = (data[3] & 0x80) ? -temp : temp;
+            dht11_cache.humidity = data[0] + data[1] * 0.1f;
+            dht11_cache.tick = rt_tick_get();
+            dht11_cache.reads++;
+            dht11_valid = RT_TRUE;
+        }
+        else
+        {
+            dht11_cache.errors++;
+        }
+        rt_exit_critical();
+
+        rt_thread_mdelay(DHT11_PERIOD_MS - DHT11_START_LOW_MS - DHT11_FRAME_MS);
+    }
+}
+
+/**
+ * @brief  初始化并启动后台采样线程
+ * @param  pin 数据引脚
+ */
+rt_err_t dht11_init(rt_base_t pin)
+{
+    if (dht11_thread != RT_NULL) return RT_EOK;
+
+    // 下降沿时间戳使用 DWT 周期计数器
+#ifdef DCB
+    DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+#else
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#endif
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    dht11_pin = pin;
+    rt_pin_mode(pin, PIN_MODE_INPUT_PULLUP);
+    if (rt_pin_attach_irq(pin, PIN_IRQ_MODE_FALLING, dht11_edge_isr, RT_NULL) != RT_EOK)
+    {
+        rt_kprintf("[DHT11] Attach pin irq failed.\n");
+        return -RT_ERROR;
+    }
+
+    dht11_thread = rt_thread_create("dht11", dht11_entry, RT_NULL, 512, 13, 10);
+    if (dht11_thread == RT_NULL) return -RT_ENOMEM;
+    rt_thread_startup(dht11_thread);
+    return RT_EOK;
+}
+
+/**
+ * @brief  取得最近一次成功读取的结果，不等待传感器
+ * @return 上电后尚未成功读取过时返回 -RT_EEMPTY
+ */
+rt_err_t dht11_read(dht11_reading_t *reading)
+{
+    rt_enter_critical();
+    *reading = dht11_cache;
+    rt_bool_t valid = dht11_valid;
+    rt_exit_critical();
+    return valid ? RT_EOK : -RT_EEMPTY;
+}
+
+/**
+ * @return 结果距今的时间 (ms)
+ */
+rt_uint32_t dht11_age_ms(const dht11_reading_t *reading)
+{
+    return (rt_tick_get() - reading->tick) * 1000U / RT_TICK_PER_SECOND;
+}
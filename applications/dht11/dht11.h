@@ -0,0 +1,33 @@
+#ifndef DHT11_H
+#define DHT11_H
+
+/*******************************************************************************
+ * DHT11 异步驱动
+ *
+ * 后台线程发出起始信号后只打开引脚下降沿中断，由中断记录每个下降沿的
+ * DWT 周期计数，传输结束后再按相邻下降沿的间隔解码 40 位数据。
+ * 整个过程不关中断、不忙等；调用方读取的是最近一次成功结果的缓存，
+ * 附带采样时刻，由调用方按数据新旧决定是否采用。
+ ******************************************************************************/
+#include <rtthread.h>
+
+#define DHT11_PERIOD_MS         1000    // 采样周期，DHT11 两次读取至少间隔 1 s
+#define DHT11_START_LOW_MS      20      // 起始信号低电平时间（规格要求 ≥18 ms）
+#define DHT11_FRAME_MS          6       // 一帧最长约 5 ms
+#define DHT11_BIT_THRESHOLD_US  100     // 相邻下降沿间隔：0 约 78 us，1 约 120 us
+#define DHT11_STALE_MS          5000    // 超过该时长未成功读取，调用方应视为无效
+
+/* 最近一次成功读取的结果 */
+typedef struct {
+    float temperature;          // 温度 (°C)
+    float humidity;             // 相对湿度 (%)
+    rt_tick_t tick;             // 采样时刻
+    rt_uint32_t reads;          // 成功次数
+    rt_uint32_t errors;         // 失败次数（无应答、位数不足或校验错误）
+} dht11_reading_t;
+
+rt_err_t dht11_init(rt_base_t pin);
+rt_err_t dht11_read(dht11_reading_t *reading);
+rt_uint32_t dht11_age_ms(const dht11_reading_t *reading);
+
+#endif /* DHT11_H */
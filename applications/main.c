@@ -4,7 +4,12 @@
 #include <stdlib.h> // for atof()
 #include <string.h> // for strcmp()
 #include <system_vars.h>
-#include <math.h>   // for log()
+#include "telemetry.h"
+#include "tune.h"
+#include "ntc.h"
+#include "dht11.h"
+#include "sensor_hub.h"
+#include <math.h>   // for fabsf()
 #include "fsl_pwm.h"
 /*******************************************************************************
  * 线程句柄
@@ -16,82 +21,32 @@ rt_thread_t pid_thread = RT_NULL;
 /*******************************************************************************
  * 设备句柄
  ******************************************************************************/
-rt_device_t dht_temp_dev = RT_NULL;
-rt_device_t dht_humi_dev = RT_NULL;
 rt_device_t adc_dev = RT_NULL;
 rt_pwm_t pwm_dev = RT_NULL;
+rt_device_t control_timer_dev = RT_NULL;
+static struct rt_semaphore control_tick_sem;   // 控制节拍信号量，由硬件定时器中断释放
+static struct rt_semaphore box_sample_sem;     // 箱温新样本通知，由传感器中枢释放
 
 /*******************************************************************************
  * 参数定义
  ******************************************************************************/
-/* 传感器信息 */
-volatile float env_temperature = 25.0f;        // 环境温度
-volatile float current_humidity = 50.0f;       // 当前湿度值
-volatile float current_temperature = 25.0f;    // 当前温度值
-volatile float target_temperature = 40.0f;     // 目标温度值
-volatile float ptc_temperature = 25.0f;        // PTC温度值
-volatile float ptc_target_temp = 40.0f;        // PTC目标温度
-
-/* 温控参数 */
-float warming_threshold = 3.0f;       // 当前保温阈值 (由前馈表决定)
-float warming_bias = 5.0f;            // 保温偏置温度（PTC温度高于目标温度多少用于保温）
-float heating_bias = 30.0f;           // 加热偏置温度（PTC温度高于目标温度多少用于加热）
-float hysteresis_band = 2.0f;         // 迟滞范围
-float fan_min = 0.00f;                // 最小风速
-float fan_max = 0.63f;                // 最大风速
-
 /* 控制状态与监控变量 */
-pid_ctx_t pid_box;  // 外环PID控制PTC目标温度
-pid_ctx_t pid_ptc;  // 内环PID控制PTC温度
-pid_ctx_t pid_cool; // 风扇 PI
-volatile control_state_t control_state = CONTROL_STATE_WARMING;
 volatile rt_uint32_t ptc_state = HEAT;
-volatile float final_pwm_duty = 0.0f;          // 当前PWM占空比
-/*******************************************************************************
- * 前馈表
- ******************************************************************************/
-typedef struct {
-    float target_temp;         // PTC目标温度
-    float base_pwm;            // 对应的PWM占空比
-} ff_profile_t;
-ff_profile_t ff_table[] = {
-    { 20.0f, 0.18f }, 
-    { 25.0f, 0.23f },     
-    { 30.0f, 0.27f },     
-    { 40.0f, 0.36f },     
-    { 50.0f, 0.46f },     
-    { 60.0f, 0.55f },
-    { 70.0f, 0.64f },
-    { 80.0f, 0.73f },
-    { 90.0f, 0.82f },
-    {100.0f, 0.91f }
-};
-const int num_ff_profiles = sizeof(ff_table) / sizeof(ff_table[0]);
-
-typedef struct {
-    float target_temp;            // 目标温度
-    float ptc_temp;               // 维持目标温度需要的PTC温度
-} warming_ff_entry_t;
-static warming_ff_entry_t warming_ff_table[] = {
-    { 25.0f, 35.0f },
-    { 30.0f, 40.5f },
-    { 40.0f, 53.0f },
-    { 57.0f, 85.0f },
-    { 70.0f, 100.0f }
-};
-const int num_warming_ff_entries = sizeof(warming_ff_table) / sizeof(warming_ff_table[0]);
+
+/* 调参事务 */
+static struct rt_mutex tune_lock;              // 串行化 MSH 与远程线程的参数提交
+static tune_session_t tune_session;            // 事务以打开它的线程为归属
 
 /*******************************************************************************
  * 函数声明
  ******************************************************************************/
 void working_led();
 extern void remote_start(int argc, char **argv);
-void tune(int argc, char **argv);
+int tune(int argc, char **argv);
 static const char* control_state_to_string(control_state_t state);
 rt_err_t initialization();
-static float get_feedforward_pwm(float target_temp);
-static float get_warming_temp(float target_temp);
-static float ntc_adc_to_temp(uint32_t adc_val);
+static rt_device_t control_timer_start(void);
+static rt_err_t box_sample_ready(rt_device_t dev, rt_size_t size);
 void pid_entry(void *parameter);
 /*----------------------------------------------------------------------------*/
 int main(void)
@@ -105,15 +60,14 @@ int main(void)
 #elif defined(__GNUC__)
     rt_kprintf("using gcc, version: %d.%d\n", __GNUC__, __GNUC_MINOR__);
 #endif
-    struct rt_sensor_data dht_temp_data;
-    struct rt_sensor_data dht_humi_data;
-    rt_uint32_t adc_value = 0;
-    if(initialization(&dht_temp_dev, &dht_humi_dev, &adc_dev, &pwm_dev) != RT_EOK) {
+    sensor_sample_t sample;
+    rt_device_t box_temp_dev;
+    if(initialization() != RT_EOK) {
         rt_kprintf("Initialization failed!\n");
         return -RT_ERROR;
     }
     /* 启动线程 */
-    pid_thread = rt_thread_create("PIDControl", pid_entry, RT_NULL, 1024, 10, 30);
+    pid_thread = rt_thread_create("PIDControl", pid_entry, RT_NULL, 2048, 10, 30);
     if (pid_thread != RT_NULL) {
         rt_thread_startup(pid_thread);
     }
@@ -127,32 +81,26 @@ int main(void)
         rt_thread_startup(screen_thread);
         rt_kprintf("Screen & Indicating Threads started successfully.\n");
     }
+    /* 订阅箱温：每有新样本释放一次信号量 */
+    rt_sem_init(&box_sample_sem, "box_smp", 0, RT_IPC_FLAG_PRIO);
+    box_temp_dev = rt_device_find("temp_box");
+    if (box_temp_dev != RT_NULL && rt_device_open(box_temp_dev, RT_DEVICE_FLAG_INT_RX) == RT_EOK) {
+        rt_device_set_rx_indicate(box_temp_dev, box_sample_ready);
+    }
     /***************************************************************************
      * 温控状态控制循环
      ************************************************************************/
     while (1)
     {
-        // 读取环境信息
-        p3t1755_read_temp(&env_temperature);
-        if (1 != rt_device_read(dht_temp_dev, 0, &dht_temp_data, 1)) continue;
-        else current_temperature = (float)(dht_temp_data.data.temp) / 10.0f;
-        if (1 != rt_device_read(dht_humi_dev, 0, &dht_humi_data, 1)) 
-        {
-            rt_kprintf("Read humi data failed.\n");
-            continue;
-        }
-        else current_humidity = (float)(dht_humi_data.data.humi) / 10.0f;
+        // 等待新的箱温样本；传感器失联时按采样周期照常判定状态
+        rt_sem_take(&box_sample_sem, rt_tick_from_millisecond(SAMPLE_PERIOD_MS * 2));
+        rt_sem_control(&box_sample_sem, RT_IPC_CMD_RESET, 0);
+        // 箱温由PID线程的状态估计写入 current_temperature
+        if (sensor_hub_get(SENSOR_HUB_ENV_TEMP, &sample) == RT_EOK) env_temperature = sample.value;
+        if (sensor_hub_get(SENSOR_HUB_BOX_HUMI, &sample) == RT_EOK) current_humidity = sample.value;
 
         control_state_t previous_state = control_state;
-        float upper_bound = target_temperature + hysteresis_band;
-        float lower_bound = target_temperature - hysteresis_band;
-        if (current_temperature < lower_bound) {
-            control_state = CONTROL_STATE_HEATING;
-        } else if (current_temperature > upper_bound + 1) {
-            control_state = CONTROL_STATE_COOLING;
-        } else if (current_temperature < upper_bound ) {
-            control_state = CONTROL_STATE_WARMING;
-        }
+        control_state = control_select_state(previous_state, current_temperature);
         
         // 处理状态切换
         if (control_state != previous_state) {
@@ -160,15 +108,10 @@ int main(void)
             // 切换前关闭PWM
             rt_pwm_set(pwm_dev, 0, PTC_PERIOD, 0);
             rt_thread_mdelay(20);
+            control_on_state_change(control_state);
             if (control_state == CONTROL_STATE_COOLING) {
                 ptc_state = COOL;
                 rt_pin_write(STATE_PIN, ptc_state);
-                pid_cool.integral = 0.0f; // 重置积分
-                pid_cool.prev_error = 0.0f;
-                pid_box.integral = 0.0f;
-                pid_box.prev_error = 0.0f;
-                pid_ptc.integral = 0.0f;
-                pid_ptc.prev_error = 0.0f;
             } else {
                 ptc_state = HEAT;
                 rt_pin_write(STATE_PIN, ptc_state);
@@ -178,7 +121,6 @@ int main(void)
         // rt_kprintf("PTC Temp: %.2f C | Current Temp: %.2f C, Target Temp: %.2f C, Env Temp: %.2f C, Humidity: %.2f %% | PWM: %.2f %%\n",
         //             ptc_temperature,current_temperature, target_temperature, env_temperature, current_humidity, final_pwm_duty * 100.0f);
         
-        rt_thread_mdelay(SAMPLE_PERIOD_MS);
     }
     
     return 0;
@@ -190,85 +132,120 @@ int main(void)
 void pid_entry(void *parameter)
 {
     rt_kprintf("PID control thread started.\n");
-    float dt = CONTROL_PERIOD_MS / 1000.0f;
-    float fan_cmd = 0.0f;
+    rt_sem_init(&control_tick_sem, "ctl_tick", 0, RT_IPC_FLAG_PRIO);
+    control_timer_dev = control_timer_start();
+    if (control_timer_dev == RT_NULL) {
+        rt_kprintf("Control timer '%s' unavailable, pacing with rt_thread_delay_until.\n", APP_CONTROL_TIMER_DEV_NAME);
+    }
+
+    /* DWT周期计数器测量实际控制周期 */
+#ifdef DCB
+    DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+#else
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#endif
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    rt_uint32_t last_cycles = DWT->CYCCNT;
+    rt_tick_t wake_tick = rt_tick_get();
+    control_snapshot_t snap;
+    sensor_sample_t box;
+    rt_uint32_t box_seq = 0;
+    float box_measured = current_temperature;
+    rt_uint32_t adc_empty = 0;              // 连续读不到 ADC 采样的周期数
     while (1)
     {
-        rt_uint32_t adc_value = rt_adc_read(adc_dev, 0);
-        ptc_temperature = ntc_adc_to_temp(adc_value);
-        
-        float error = 0.0f;
-        float output = 0.0f;
-        
-        switch(control_state)
-        {
-            case CONTROL_STATE_HEATING:
-            case CONTROL_STATE_WARMING:
-            {
-                // 外环PID：控制箱内温度，输出PTC的目标温度
-                float outer_error = target_temperature - current_temperature;
-                pid_box.integral += outer_error * dt;
-                if(pid_box.integral > 100.0f) pid_box.integral = 100.0f;
-                if(pid_box.integral < -100.0f) pid_box.integral = -100.0f;
-                float outer_derivative = (outer_error - pid_box.prev_error) / dt;
-                float outer_output = pid_box.kp * outer_error + pid_box.ki * pid_box.integral + pid_box.kd * outer_derivative;
-                // 计算PTC目标温度
-                ptc_target_temp = get_warming_temp(target_temperature) + outer_output;
-                float ratio = fabs(outer_error + hysteresis_band) / (hysteresis_band * 2);
-                if (ratio > 1) ratio = 1;
-                float dynamic_bias = warming_bias + (heating_bias - warming_bias) * ratio;
-                if (ptc_target_temp > target_temperature + dynamic_bias) ptc_target_temp = target_temperature + dynamic_bias;
-                else if (ptc_target_temp < target_temperature + warming_bias) ptc_target_temp = target_temperature + warming_bias;
-                if (ptc_target_temp > PTC_MAX_SAFE_TEMP) ptc_target_temp = PTC_MAX_SAFE_TEMP;
-                
-                pid_box.prev_error = outer_error;
-
-                // 内环PID：控制PTC温度到ptc_target_temp
-                if (ptc_temperature >= PTC_MAX_SAFE_TEMP) {
-                    output = 0.0f; // 过热保护
-                    rt_kprintf("WARNING: PTC Overheat! Temp: %.1f\n", ptc_temperature);
-                } else {
-                    float inner_error = ptc_target_temp - ptc_temperature;
-                    pid_ptc.integral += inner_error * dt;
-                    if(pid_ptc.integral > 50.0f) pid_ptc.integral = 50.0f;
-                    if(pid_ptc.integral < -50.0f) pid_ptc.integral = -50.0f;
-                    float inner_derivative = (inner_error - pid_ptc.prev_error) / dt;
-                    output = pid_ptc.kp * inner_error + pid_ptc.ki * pid_ptc.integral + pid_ptc.kd * inner_derivative;
-                    output += get_feedforward_pwm(ptc_target_temp);
-                    if (output > pid_ptc.out_max) output = pid_ptc.out_max;
-                    if (output < pid_ptc.out_min) output = pid_ptc.out_min;
-                    pid_ptc.prev_error = inner_error;
-                }
-                break;
+        // 等待下一个控制节拍（定时器节拍不受本周期计算耗时和抢占影响）
+        rt_uint32_t missed = 0;
+        if (control_timer_dev != RT_NULL) {
+            if (rt_sem_take(&control_tick_sem, rt_tick_from_millisecond(2 * CONTROL_PERIOD_MS)) == RT_EOK) {
+                missed = control_tick_sem.value;
+                if (missed > 0) rt_sem_control(&control_tick_sem, RT_IPC_CMD_RESET, 0);
+            } else {
+                // 定时器已打开却不产生节拍：计一次超限，关闭定时器改用 rt_thread_delay_until 定时
+                missed = 1;
+                rt_device_close(control_timer_dev);
+                control_timer_dev = RT_NULL;
+                wake_tick = rt_tick_get();
+                rt_kprintf("Control timer '%s' stopped ticking, pacing with rt_thread_delay_until.\n", APP_CONTROL_TIMER_DEV_NAME);
             }
-            case CONTROL_STATE_COOLING:
-                // 风扇 PI 控制
-                error = current_temperature - target_temperature;
-                pid_cool.integral += error * dt;
-                if(pid_cool.integral > 50.0f) pid_cool.integral = 50.0f;
-                if(pid_cool.integral < -50.0f) pid_cool.integral = -50.0f;
-                output = pid_cool.kp * error + pid_cool.ki * pid_cool.integral;
-                fan_cmd = fan_cmd + 0.37 * (output - fan_cmd);// 一阶滤波平滑输出
-                output = fan_cmd;
-                if (output > pid_cool.out_max) output = pid_cool.out_max;
-                if (output < pid_cool.out_min) output = pid_cool.out_min;
-                pid_cool.prev_error = error;
-                break;
-            default:
-                output = 0.0f;
-                pid_box.integral *= 0.98f;
-                pid_ptc.integral *= 0.98f;
-                pid_cool.integral *= 0.98f;
-                break;
+        } else {
+            rt_thread_delay_until(&wake_tick, rt_tick_from_millisecond(CONTROL_PERIOD_MS));
         }
+        rt_uint32_t now_cycles = DWT->CYCCNT;
+        float dt = control_timing_update((float)(now_cycles - last_cycles) / SystemCoreClock, missed);
+        last_cycles = now_cycles;
 
-        
-        final_pwm_duty = output;
+        // 开启 BSP_USING_ADC0_DMA 时为最近一个采样窗口的中位数，不等待转换；自上次读取以来没有新采样时返回 0，沿用上一周期的值。
+        // 连续 PTC_SENSOR_FAULT_CYCLES 个周期没有新采样（采集未启动，或触发/DMA 已停止）时视为传感器故障，control_step 关断输出
+        rt_uint32_t adc_value = rt_adc_read(adc_dev, 0);
+        if (adc_value > 0) {
+            ptc_temperature = ntc_adc_to_temp(adc_value);
+            if (ptc_sensor_fault) rt_kprintf("PTC sensor recovered after %u empty reads.\n", (unsigned int)adc_empty);
+            adc_empty = 0;
+            ptc_sensor_fault = 0;
+        } else if (++adc_empty >= PTC_SENSOR_FAULT_CYCLES && !ptc_sensor_fault) {
+            ptc_sensor_fault = 1;
+            rt_kprintf("ERROR: No PTC ADC samples for %u cycles, heater output disabled.\n", (unsigned int)adc_empty);
+        }
+
+        // 箱温估计：热模型预测 + NTC 每周期融合，DHT11 新样本按其年龄对齐后融合
+        rt_uint32_t compute_start = DWT->CYCCNT;
+        control_estimate(dt, ptc_state == HEAT);
+        if (sensor_hub_get(SENSOR_HUB_BOX_TEMP, &box) == RT_EOK && box.seq != box_seq) {
+            box_seq = box.seq;
+            box_measured = box.value;
+            control_estimate_box(box.value, (float)(sensor_hub_now_us() - box.timestamp_us) * 1e-6f);
+        }
+        control_identify(dt, ptc_state == HEAT, box_measured);
+
+        control_step(dt);
+        control_timing_compute((float)(DWT->CYCCNT - compute_start) / SystemCoreClock);
 
         rt_uint32_t pulse = (rt_uint32_t)(final_pwm_duty * PTC_PERIOD);
         rt_pwm_set(pwm_dev, 0, PTC_PERIOD, pulse);
-        rt_thread_mdelay(CONTROL_PERIOD_MS);
+
+        control_snapshot_publish(rt_tick_get_millisecond(), ptc_state == HEAT);
+        control_snapshot_read(&snap);
+        telemetry_append(&snap);
+    }
+}
+
+static rt_err_t box_sample_ready(rt_device_t dev, rt_size_t size)
+{
+    rt_sem_release(&box_sample_sem);
+    return RT_EOK;
+}
+
+static rt_err_t control_timer_timeout(rt_device_t dev, rt_size_t size)
+{
+    rt_sem_release(&control_tick_sem);
+    return RT_EOK;
+}
+
+/**
+ * @brief  以周期模式启动控制节拍硬件定时器
+ * @return 定时器设备，失败时返回 RT_NULL
+ */
+static rt_device_t control_timer_start(void)
+{
+    rt_hwtimer_mode_t mode = HWTIMER_MODE_PERIOD;
+    rt_hwtimerval_t timeout;
+    rt_device_t timer = rt_device_find(APP_CONTROL_TIMER_DEV_NAME);
+    if (timer == RT_NULL) return RT_NULL;
+
+    if (rt_device_open(timer, RT_DEVICE_OFLAG_RDWR) != RT_EOK) return RT_NULL;
+    rt_device_set_rx_indicate(timer, control_timer_timeout);
+    if (rt_device_control(timer, HWTIMER_CTRL_MODE_SET, &mode) != RT_EOK) {
+        rt_device_close(timer);
+        return RT_NULL;
     }
+    timeout.sec = CONTROL_PERIOD_MS / 1000;
+    timeout.usec = (CONTROL_PERIOD_MS % 1000) * 1000;
+    if (rt_device_write(timer, 0, &timeout, sizeof(timeout)) != sizeof(timeout)) {
+        rt_device_close(timer);
+        return RT_NULL;
+    }
+    return timer;
 }
 
 rt_err_t initialization()
@@ -277,39 +254,24 @@ rt_err_t initialization()
 
     /* 初始化控制状态 */
     ptc_state = HEAT;
-    control_state = CONTROL_STATE_WARMING;
-    // 加热PID 
-    //TODO!:(需要整定，建模中，或者可以使用一些机器学习方法，把目标函数黑盒转换为凸函数，然后做凸优化)
-    pid_ptc.kp = 1.37f;
-    pid_ptc.ki = 0.10f;
-    pid_ptc.kd = 0.70f;
-    pid_ptc.out_min = 0.0f;
-    pid_ptc.out_max = 1.0f;
-    pid_box.kp = 0.10f;
-    pid_box.ki = 0.76f;
-    pid_box.kd = 0.37f;
-    pid_box.out_min = 0.0f;
-    pid_box.out_max = 1.0f;
-    // 风冷PI (需要整定)
-    pid_cool.kp = 0.01f;
-    pid_cool.ki = 0.001f;
-    pid_cool.kd = 0.0f;
-    pid_cool.out_min = fan_min;
-    pid_cool.out_max = fan_max;
+    control_init();
+    telemetry_init();
+    ntc_init(NTC_R25, NTC_B_VALUE, NTC_SERIES_R);
+    rt_mutex_init(&tune_lock, "tune", RT_IPC_FLAG_PRIO);
     rt_pin_mode(STATE_PIN, PIN_MODE_OUTPUT);
     rt_pin_write(STATE_PIN, ptc_state);
 
     /* 初始化温度传感器 */
     result |= p3t1755_init(); // 板载
-    dht_temp_dev = rt_device_find("temp_dht");
-    dht_humi_dev = rt_device_find("humi_dht");
-    if (dht_temp_dev && dht_humi_dev) {
-        result |= rt_device_open(dht_temp_dev, RT_DEVICE_FLAG_RDWR);
-        result |= rt_device_open(dht_humi_dev, RT_DEVICE_FLAG_RDWR);
-    } else {
-        rt_kprintf("DHT device not found.\n");
+    if (dht11_init(DHT_DATA_PIN) != RT_EOK) {
+        rt_kprintf("DHT11 init failed.\n");
         result = -RT_ERROR;
-    } 
+    }
+    /* 传感器中枢：按各自节奏采样并发布带时间戳的样本 */
+    if (sensor_hub_init() != RT_EOK) {
+        rt_kprintf("Sensor hub init failed.\n");
+        result = -RT_ERROR;
+    }
 
     /* 初始化 ADC */
     adc_dev = (rt_adc_device_t)rt_device_find(PTC_TEMP_ADC);
@@ -347,61 +309,6 @@ void working_led() {
     }
 }
 
-static float get_feedforward_pwm(float target_temp)
-{
-    float dt = target_temp;
-    if (dt <= ff_table[0].target_temp) return ff_table[0].base_pwm;
-    if (dt >= ff_table[num_ff_profiles - 1].target_temp)
-        return ff_table[num_ff_profiles - 1].base_pwm;
-
-    for (int i = 0; i < num_ff_profiles - 1; i++)
-    {
-        ff_profile_t *a = &ff_table[i];
-        ff_profile_t *b = &ff_table[i + 1];
-        if (dt >= a->target_temp && dt <= b->target_temp)
-        {
-            float ratio = (dt - a->target_temp) / (b->target_temp - a->target_temp);
-            return a->base_pwm + ratio * (b->base_pwm - a->base_pwm);
-        }
-    }
-    return 0.0f; // 理论上不会走到这里
-}
-
-static float get_warming_temp(float target_temp)
-{
-    float ptc_temp = warming_ff_table[0].ptc_temp;
-    if (target_temp <= warming_ff_table[0].target_temp)
-        ptc_temp = warming_ff_table[0].ptc_temp;
-    else if (target_temp >= warming_ff_table[num_warming_ff_entries - 1].target_temp)
-        ptc_temp = warming_ff_table[num_warming_ff_entries - 1].ptc_temp;
-    else
-    {
-        for (int i = 0; i < num_warming_ff_entries - 1; i++)
-        {
-            warming_ff_entry_t *a = &warming_ff_table[i];
-            warming_ff_entry_t *b = &warming_ff_table[i + 1];
-            if (target_temp >= a->target_temp && target_temp <= b->target_temp)
-            {
-                float ratio = (target_temp - a->target_temp) / (b->target_temp - a->target_temp);
-                ptc_temp = a->ptc_temp + ratio * (b->ptc_temp - a->ptc_temp);
-                break;
-            }
-        }
-    }
-    return ptc_temp;
-}
-
-static float ntc_adc_to_temp(uint32_t adc_val)
-{
-    if (adc_val >= 65535) return -100.0f;
-    float voltage = (float)adc_val * ADC_REF_VOLTAGE / ADC_RESOLUTION;
-    float r_ntc = NTC_SERIES_R * voltage / (ADC_REF_VOLTAGE - voltage);
-    float ln_r = log(r_ntc / NTC_R25);
-    float t_kelvin = 1.0f / ((1.0f / 298.15f) + (ln_r / NTC_B_VALUE));
-    
-    return t_kelvin - 273.15f;
-}
-
 static const char* control_state_to_string(control_state_t state)
 {
     switch(state)
@@ -421,35 +328,77 @@ static const char* control_state_to_string(control_state_t state)
  ******************************************************************************/
 static void get_status(int argc, char **argv)
 {
+    control_snapshot_t snap;
+    control_snapshot_read(&snap);
+
     rt_kprintf("----- System Status -----\n");
-    rt_kprintf("State:                %s\n", control_state_to_string(control_state));
-    rt_kprintf("Box Temp:             %.2f C\n", current_temperature);
-    rt_kprintf("Target Temp:          %.2f C\n", target_temperature);
-    rt_kprintf("PTC Temp:             %.2f C\n", ptc_temperature);
-    rt_kprintf("Humidity:             %.1f %%\n", current_humidity);
-    rt_kprintf("PWM Duty Cycle:       %.1f %%\n", final_pwm_duty * 100.0f);
-    rt_kprintf("Hysteresis Band:      +/- %.2f C\n", hysteresis_band);
+    rt_kprintf("Mode:                 %s\n", snap.mode == CONTROL_MODE_MPC ? "MPC" : "PID");
+    rt_kprintf("State:                %s\n", control_state_to_string(snap.state));
+    if (snap.ptc_sensor_fault)
+        rt_kprintf("PTC Sensor:           FAULT (no ADC samples, output forced to 0)\n");
+    rt_kprintf("Box Temp:             %.2f +/- %.2f C (estimated)\n", snap.current_temperature, snap.box_std);
+    rt_kprintf("Target Temp:          %.2f C\n", snap.target_temperature);
+    rt_kprintf("PTC Temp:             %.2f C\n", snap.ptc_temperature);
+    rt_kprintf("Humidity:             %.1f %%\n", snap.current_humidity);
+    rt_kprintf("PWM Duty Cycle:       %.1f %%\n", snap.pwm_duty * 100.0f);
+    rt_kprintf("Hysteresis Band:      +/- %.2f C\n", snap.hysteresis_band);
+
+    rt_kprintf("\n----- Control Loop Timing -----\n");
+    rt_kprintf("Tick Source:          %s\n", control_timer_dev ? APP_CONTROL_TIMER_DEV_NAME : "rt_thread_delay_until");
+    rt_kprintf("Cycles / Overruns:    %u / %u\n", (unsigned int)snap.timing.cycles, (unsigned int)snap.timing.overruns);
+    rt_kprintf("Period Last:          %.3f ms\n", snap.timing.dt_last * 1000.0f);
+    rt_kprintf("Period Min/Max:       %.3f / %.3f ms\n", snap.timing.dt_min * 1000.0f, snap.timing.dt_max * 1000.0f);
+    rt_kprintf("Jitter RMS:           %.3f ms\n", snap.timing.jitter_rms * 1000.0f);
+    rt_kprintf("Compute Last/Max:     %.3f / %.3f ms (budget %d ms)\n",
+               snap.timing.compute_last * 1000.0f, snap.timing.compute_max * 1000.0f, CONTROL_PERIOD_MS);
+
+    if (snap.mode == CONTROL_MODE_MPC) {
+        // MPC 内部状态只由PID线程更新，这里仅用于显示，不保证与快照同一周期
+        rt_kprintf("\n----- MPC -----\n");
+        rt_kprintf("Actuator:             %s\n", control_mpc.actuator == MPC_ACT_FAN ? "FAN" : "PTC");
+        rt_kprintf("Cost PTC/FAN:         %.2f / %.2f\n", control_mpc.cost[MPC_ACT_HEAT], control_mpc.cost[MPC_ACT_FAN]);
+        rt_kprintf("Predicted PTC:        %.2f C\n", snap.ptc_target_temp);
+        rt_kprintf("Actuator Switches:    %u\n", (unsigned int)control_mpc.switches);
+        return;
+    }
 
     rt_kprintf("\n----- PID Controllers -----\n");
+    if (snap.num_sched > 0)
+        rt_kprintf("Gains interpolated from a %d-point schedule at %.2f C (tune sched)\n", snap.num_sched, snap.target_temperature);
     
     // 根据当前状态，高亮活动的控制器
-    const char* heat_active_str = (control_state != CONTROL_STATE_COOLING) ? " (ACTIVE)" : "";
+    const char* heat_active_str = (snap.state != CONTROL_STATE_COOLING) ? " (ACTIVE)" : "";
     rt_kprintf("Outer PID (Box)%s\n", heat_active_str);
-    rt_kprintf("  Gains:    Kp=%.3f, Ki=%.3f, Kd=%.3f\n", pid_box.kp, pid_box.ki, pid_box.kd);
-    rt_kprintf("  Internal: I-Term=%.3f, Prev-Err=%.3f\n", pid_box.integral, pid_box.prev_error);
+    rt_kprintf("  Gains:    Kp=%.3f, Ki=%.3f, Kd=%.3f\n", snap.pid_box.kp, snap.pid_box.ki, snap.pid_box.kd);
+    rt_kprintf("  Internal: I-Term=%.3f, Prev-Err=%.3f\n", snap.pid_box.integral, snap.pid_box.prev_error);
 
     rt_kprintf("Inner PID (PTC)%s\n", heat_active_str);
-    rt_kprintf("  Gains:    Kp=%.3f, Ki=%.3f, Kd=%.3f\n", pid_ptc.kp, pid_ptc.ki, pid_ptc.kd);
-    rt_kprintf("  Internal: I-Term=%.3f, Prev-Err=%.3f\n", pid_ptc.integral, pid_ptc.prev_error);
+    rt_kprintf("  Gains:    Kp=%.3f, Ki=%.3f, Kd=%.3f\n", snap.pid_ptc.kp, snap.pid_ptc.ki, snap.pid_ptc.kd);
+    rt_kprintf("  Internal: I-Term=%.3f, Prev-Err=%.3f\n", snap.pid_ptc.integral, snap.pid_ptc.prev_error);
 
-    const char* cool_active_str = (control_state == CONTROL_STATE_COOLING) ? " (ACTIVE)" : "";
+    const char* cool_active_str = (snap.state == CONTROL_STATE_COOLING) ? " (ACTIVE)" : "";
     rt_kprintf("Cooling PI%s\n", cool_active_str);
-    rt_kprintf("  Gains:    Kp=%.3f, Ki=%.3f\n", pid_cool.kp, pid_cool.ki);
-    rt_kprintf("  Internal: I-Term=%.3f, Prev-Err=%.3f\n", pid_cool.integral, pid_cool.prev_error);
+    rt_kprintf("  Gains:    Kp=%.3f, Ki=%.3f\n", snap.pid_cool.kp, snap.pid_cool.ki);
+    rt_kprintf("  Internal: I-Term=%.3f, Prev-Err=%.3f\n", snap.pid_cool.integral, snap.pid_cool.prev_error);
 }
 MSH_CMD_EXPORT(get_status, Get current system status for temperature control);
 
-void tune(int argc, char **argv)
+/**
+ * @brief  修改参数，不打印状态（远程批量调参用，避免每条命令都刷一屏串口输出）
+ * @return 参数有误、找不到对应条目或事务冲突时返回负值
+ */
+int tune_apply(int argc, char **argv)
+{
+    if (argc < 2) return -RT_ERROR;
+
+    rt_mutex_take(&tune_lock, RT_WAITING_FOREVER);
+    int result = tune_session_apply(&tune_session, rt_thread_self(), argc, argv);
+    rt_mutex_release(&tune_lock);
+    if (result == TUNE_OK) return RT_EOK;
+    return (result == TUNE_BUSY) ? -RT_EBUSY : -RT_ERROR;
+}
+
+int tune(int argc, char **argv)
 {
     if (argc < 2) {
         rt_kprintf("\n----- Usage -----\n");
@@ -457,118 +406,62 @@ void tune(int argc, char **argv)
         rt_kprintf("  tune hys <val>             (Set hysteresis band in C)\n");
         rt_kprintf("  tune warmbias <val>        (Set warming bias temperature in C)\n");
         rt_kprintf("  tune heatbias <val>        (Set heating bias temperature in C)\n");
-        rt_kprintf("  tune ff <0-ptc/1-warmt> <temp> <val> (Set feedforward value)\n");
+        rt_kprintf("  tune ff <0-ptc/1-warmt> <temp> <val> (Set or insert a feedforward point)\n");
+        rt_kprintf("  tune ff del <0|1> <temp> | clear <0|1>\n");
+        rt_kprintf("  tune ff load <0|1> <temp:val>[,<temp:val>...] ...\n");
+        rt_kprintf("                             (Add many points per line; clear + load inside begin/commit)\n");
+        rt_kprintf("  tune ff                    (List the feedforward tables)\n");
         rt_kprintf("  tune box <kp|ki|kd> <val>  (Tune outer box PID)\n");
         rt_kprintf("  tune heat <kp|ki|kd> <val> (Tune inner PTC PID)\n");
         rt_kprintf("  tune cool <kp|ki> <val>    (Tune cooling PI)\n");
+        rt_kprintf("  tune mode <pid|mpc>        (Select cascade PID or model-predictive control)\n");
+        rt_kprintf("  tune sched <temp> <box|heat|cool> <kp> <ki> [kd]\n");
+        rt_kprintf("                             (Add/edit a gain schedule point; del <temp> | clear)\n");
+        rt_kprintf("  tune sched                 (List the gain schedule)\n");
+        rt_kprintf("  tune begin | set <...> | commit | abort\n");
+        rt_kprintf("                             (Apply several changes in one control cycle)\n");
         rt_kprintf("\n----- Example -----\n");
         rt_kprintf("  tune heat kp 0.3\n");
         rt_kprintf("  tune target 45.5\n");
+        rt_kprintf("  tune begin; tune set heat kp 0.3; tune set heat ki 0.02; tune commit\n");
         rt_kprintf("\n");
         get_status(0, RT_NULL); // 如果没有参数，则显示当前状态
-        return;
+        return RT_EOK;
     }
 
-    const char *cmd = argv[1];
-
-    if (strcmp(cmd, "target") == 0) {
-        if (argc != 3) { rt_kprintf("Usage: tune target <value>\n"); return; }
-        target_temperature = atof(argv[2]);
-        rt_kprintf("Target temperature set to %.2f C\n", target_temperature);
-    }
-    else if (strcmp(cmd, "hys") == 0) {
-        if (argc != 3) { rt_kprintf("Usage: tune hys <value>\n"); return; }
-        hysteresis_band = atof(argv[2]);
-        rt_kprintf("Hysteresis band set to +/- %.2f C\n", hysteresis_band);
-    }
-    else if (strcmp(cmd, "warmbias") == 0) {
-        if (argc != 3) { rt_kprintf("Usage: tune warmbias <value>\n"); return; }
-        warming_bias = atof(argv[2]);
-        rt_kprintf("Warming bias temperature set to %.2f C\n", warming_bias);
-    }
-    else if (strcmp(cmd, "heatbias") == 0) {
-        if (argc != 3) { rt_kprintf("Usage: tune heatbias <value>\n"); return; }
-        heating_bias = atof(argv[2]);
-        rt_kprintf("Heating bias temperature set to %.2f C\n", heating_bias);
-    }
-    else if (strcmp(cmd, "ff") == 0) {
-        if (argc != 5) { rt_kprintf("Usage: tune ff <target(0-ptc/1-warmt)> <temp> <value>\n"); return; }
-        int table_type = atoi(argv[2]);
-        float temp = atof(argv[3]);
-        float value = atof(argv[4]);
-        rt_bool_t found = RT_FALSE;
-        if(table_type == 0) {
-            for (size_t i = 0; i < num_ff_profiles; i++)
-            {
-                if (fabsf(ff_table[i].target_temp - temp) < 2.0f) {
-                    found = RT_TRUE;
-                    ff_table[i].base_pwm = value;
-                    rt_kprintf("Feedforward PWM for %.2f C set to %.2f\n", temp, value);
-                    return;
-                }
-            }
-            if (found == RT_FALSE)
-            {
-                // TODO!：插入新条目（排序）
-                rt_kprintf("Error: No existing ptc feedforward entry near %.2f C. Addition of new entries not implemented.\n", temp);
-            }
-        } else if (table_type == 1)
-        {
-            for (size_t i = 0; i < num_warming_ff_entries; i++)
-            {
-                if (fabsf(warming_ff_table[i].target_temp - temp) < 2.0f) {
-                    found = RT_TRUE;
-                    warming_ff_table[i].ptc_temp = value;
-                    rt_kprintf("Warming feedforward PTC Temperature for %.2f C set to %.2f\n", temp, value);
-                    return;
-                }
-            }
-            if (found == RT_FALSE)
-            {
-                // TODO!：插入新条目（排序）
-                rt_kprintf("Error: No existing warming feedforward entry near %.2f C. Addition of new entries not implemented.\n", temp);
-            }
-        } else {
-            rt_kprintf("Error: Unknown feedforward table type '%d'. Use 0 for ptc, 1 for warmt.\n", table_type);
+    if (argc == 2 && strcmp(argv[1], "sched") == 0) {
+        // 列出已提交的增益调度表
+        rt_mutex_take(&tune_lock, RT_WAITING_FOREVER);
+        control_params_get(&tune_session.scratch);
+        if (tune_session.scratch.num_sched == 0) rt_kprintf("Gain schedule is empty, using fixed gains.\n");
+        for (int i = 0; i < tune_session.scratch.num_sched; i++) {
+            const gain_sched_entry_t *e = &tune_session.scratch.sched[i];
+            // 增益按 6 位小数打印，evaluate.py 据此在评估后原样恢复调度表
+            rt_kprintf("%6.2f C  box %.6f/%.6f/%.6f  heat %.6f/%.6f/%.6f  cool %.6f/%.6f/%.6f\n", e->target_temp,
+                       e->box.kp, e->box.ki, e->box.kd, e->heat.kp, e->heat.ki, e->heat.kd,
+                       e->cool.kp, e->cool.ki, e->cool.kd);
         }
-        return;
+        rt_mutex_release(&tune_lock);
+        return RT_EOK;
     }
-    else if (strcmp(cmd, "box") == 0) {
-        if (argc != 4) { rt_kprintf("Usage: tune box <kp|ki|kd> <value>\n"); return; }
-        const char *param = argv[2];
-        float value = atof(argv[3]);
-        if (strcmp(param, "kp") == 0) pid_box.kp = value;
-        else if (strcmp(param, "ki") == 0) pid_box.ki = value;
-        else if (strcmp(param, "kd") == 0) pid_box.kd = value;
-        else { rt_kprintf("Error: Unknown box param '%s'. Use kp, ki, or kd.\n", param); return; }
-        rt_kprintf("Box PID '%s' set to %f\n", param, value);
-    }
-    else if (strcmp(cmd, "heat") == 0) {
-        if (argc != 4) { rt_kprintf("Usage: tune heat <kp|ki|kd> <value>\n"); return; }
-        const char *param = argv[2];
-        float value = atof(argv[3]);
-        if (strcmp(param, "kp") == 0) pid_ptc.kp = value;
-        else if (strcmp(param, "ki") == 0) pid_ptc.ki = value;
-        else if (strcmp(param, "kd") == 0) pid_ptc.kd = value;
-        else { rt_kprintf("Error: Unknown heat param '%s'. Use kp, ki, or kd.\n", param); return; }
-        rt_kprintf("Heat PID '%s' set to %f\n", param, value);
-    }
-    else if (strcmp(cmd, "cool") == 0) {
-        if (argc != 4) { rt_kprintf("Usage: tune cool <kp|ki> <value>\n"); return; }
-        const char *param = argv[2];
-        float value = atof(argv[3]);
-        if (strcmp(param, "kp") == 0) pid_cool.kp = value;
-        else if (strcmp(param, "ki") == 0) pid_cool.ki = value;
-        else { rt_kprintf("Error: Unknown cool param '%s'. Use kp or ki.\n", param); return; }
-        rt_kprintf("Cool PI '%s' set to %f\n", param, value);
-    }
-    else {
-        rt_kprintf("Error: Unknown command '%s'\n", cmd);
-        return;
+
+    if (argc == 2 && strcmp(argv[1], "ff") == 0) {
+        // 列出已提交的两张前馈表
+        rt_mutex_take(&tune_lock, RT_WAITING_FOREVER);
+        control_params_get(&tune_session.scratch);
+        tune_print_ff(&tune_session.scratch);
+        rt_mutex_release(&tune_lock);
+        return RT_EOK;
     }
 
+    if (tune_apply(argc, argv) != RT_EOK) return -RT_ERROR;
+    if (tune_session.owner == rt_thread_self()) return RT_EOK;   // 事务尚未提交，状态没有变化
+
+    // 等待PID线程换入，显示的状态才包含本次修改
+    for (int i = 0; i < 3 && control_params_pending(); i++) rt_thread_mdelay(CONTROL_PERIOD_MS);
     rt_kprintf("\nParameters updated. Current status:\n");
     get_status(0, RT_NULL); // 每次成功修改后，自动显示最新状态
+    return RT_EOK;
 }
 MSH_CMD_EXPORT(tune, Tune system parameters (target, hys, PID gains));
 /*******************************************************************************
@@ -598,9 +491,18 @@ void eval_ptc(int argc, char **argv)
         return;
     }
     
+    // 目标温度也走参数提交，避免被之后的 tune 提交覆盖回旧值；事务进行中时提交会被事务覆盖，直接拒绝
+    rt_mutex_take(&tune_lock, RT_WAITING_FOREVER);
+    if (tune_session.owner != RT_NULL) {
+        rt_mutex_release(&tune_lock);
+        rt_kprintf("Error: A tune transaction is in progress.\n");
+        return;
+    }
     rt_kprintf("Starting PTC evaluation: Target=%.2f C, Duration=%d ms\n", eval_target_temp, eval_duration_ms);
-
-    target_temperature = eval_target_temp;
+    control_params_get(&tune_session.scratch);
+    tune_session.scratch.target_temperature = eval_target_temp;
+    control_params_commit(&tune_session.scratch);
+    rt_mutex_release(&tune_lock);
     control_state = CONTROL_STATE_WARMING;
     ptc_state = HEAT;
     rt_pin_write(STATE_PIN, HEAT);
@@ -614,13 +516,14 @@ void eval_ptc(int argc, char **argv)
     rt_uint32_t sample_count = 0;
 
     // 2. 在指定时间内运行评估循环
+    control_snapshot_t snap;
     while (rt_tick_get() - start_tick < rt_tick_from_millisecond(eval_duration_ms))
     {
         // 我们不直接控制PID，PID线程仍在后台根据当前状态(WARMING)和参数运行
         // 我们只需要在这里同步地读取PTC温度并计算误差
         
-        float current_ptc_temp = ptc_temperature; // 直接使用全局变量，它由PID线程高频更新
-        float error = current_ptc_temp - eval_target_temp;
+        control_snapshot_read(&snap); // PID线程每周期发布的快照
+        float error = snap.ptc_temperature - eval_target_temp;
         
         total_absolute_error += fabsf(error);
         sample_count++;
@@ -640,6 +543,61 @@ void eval_ptc(int argc, char **argv)
     rt_kprintf("EVAL_RESULT:%.4f\n", score); 
 }
 MSH_CMD_EXPORT(eval_ptc, Evaluate PTC PID performance for autotuning);
+
+/**
+ * @brief  查看在线辨识的热模型，或按其重新生成前馈表
+ * @usage  ident [apply|reset]
+ * @note   apply 以当前环境温度重算 ff_table / warming_ff_table（温度节点不变），
+ *         与 tune 一样经参数集提交；模型未收敛或有 tune 事务进行中时拒绝
+ */
+static int ident(int argc, char **argv)
+{
+    control_snapshot_t snap;
+    control_snapshot_read(&snap);
+    const ident_model_t *m = &snap.ident;
+
+    if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+        control_ident_reset();
+        rt_kprintf("Identification restarted from the default model.\n");
+        return RT_EOK;
+    }
+    if (argc == 2 && strcmp(argv[1], "apply") == 0) {
+        rt_mutex_take(&tune_lock, RT_WAITING_FOREVER);
+        if (tune_session.owner != RT_NULL) {
+            rt_mutex_release(&tune_lock);
+            rt_kprintf("Error: A tune transaction is in progress.\n");
+            return -RT_EBUSY;
+        }
+        control_params_get(&tune_session.scratch);
+        if (control_ident_tables(&tune_session.scratch, m, snap.env_temperature) != 0) {
+            rt_mutex_release(&tune_lock);
+            rt_kprintf("Error: Model not converged (PTC +/-%.1f%%, box +/-%.1f%%).\n",
+                       m->unc_ptc * 100.0f, m->unc_box * 100.0f);
+            return -RT_ERROR;
+        }
+        control_params_commit(&tune_session.scratch);
+        rt_kprintf("Feedforward tables regenerated at env %.1f C:\n", snap.env_temperature);
+        tune_print_ff(&tune_session.scratch);
+        const estimator_params_t *plant = &tune_session.scratch.plant;
+        rt_kprintf("Estimator model: C ptc/box %.1f/%.0f J/K, G ptc-box/box-env %.3f/%.3f W/K\n",
+                   plant->c_ptc, plant->c_box, plant->g_ptc_box, plant->g_box_env);
+        rt_mutex_release(&tune_lock);
+        return RT_EOK;
+    }
+    if (argc != 1) {
+        rt_kprintf("Usage: ident [apply|reset]\n");
+        return -RT_ERROR;
+    }
+
+    rt_kprintf("----- Plant Identification -----\n");
+    rt_kprintf("PTC tau / gain:       %.1f s / %.1f C at full duty\n", m->tau_ptc, m->k_ptc);
+    rt_kprintf("  Fit / Uncertainty:  %.2f / +/-%.1f%% (%u windows)\n", m->fit_ptc, m->unc_ptc * 100.0f, (unsigned int)m->samples_ptc);
+    rt_kprintf("Box tau / coupling:   %.0f s / %.3f\n", m->tau_box, m->k_box);
+    rt_kprintf("  Fit / Uncertainty:  %.2f / +/-%.1f%% (%u windows)\n", m->fit_box, m->unc_box * 100.0f, (unsigned int)m->samples_box);
+    rt_kprintf("Status:               %s\n", m->valid ? "converged (ident apply available)" : "not converged");
+    return RT_EOK;
+}
+MSH_CMD_EXPORT(ident, Show online plant identification or regenerate feedforward tables);
 /**
  * @brief  强制设置系统控制状态 (主要用于外部脚本调试)
  * @param  argc 参数个数
@@ -0,0 +1,101 @@
+"""
+生成 ntc_table.h：ADC 码值 → 温度的分段线性查找表
+
+用法：python gen_ntc_table.py [--r25 10000] [--b 3950] [--series 10000]
+
+参数应与 applications/system_vars.h 中的 NTC_R25 / NTC_B_VALUE / NTC_SERIES_R 一致；
+不一致时固件会在启动时按实际常数在 RAM 中重建一张表（见 ntc.c）。
+"""
+import argparse
+import math
+import os
+
+ADC_BITS = 16
+TABLE_SHIFT = 7                            # 每段 128 个码值，与 ntc.h 中 NTC_TABLE_SHIFT 一致
+TABLE_SIZE = (1 << ADC_BITS >> TABLE_SHIFT) + 1
+ADC_FULL_SCALE = 65535.0                   # 与 ADC_RESOLUTION 一致
+REPORT_RANGES = [(-20.0, 150.0), (0.0, 120.0), (20.0, 100.0)]
+
+
+def exact_temp(code, r25, b, series):
+    """与 ntc.c 中 ntc_exact_temp 相同的模型（°C）"""
+    ratio = code / ADC_FULL_SCALE
+    if ratio <= 0.0:
+        return 327.67
+    if ratio >= 1.0:
+        return -100.0
+    r_ntc = series * ratio / (1.0 - ratio)
+    return 1.0 / (1.0 / 298.15 + math.log(r_ntc / r25) / b) - 273.15
+
+
+def to_centi(t):
+    return max(-32768, min(32767, int(round(t * 100.0))))
+
+
+def build_table(r25, b, series):
+    return [to_centi(exact_temp(i << TABLE_SHIFT, r25, b, series)) for i in range(TABLE_SIZE)]
+
+
+def lookup(table, code):
+    i = code >> TABLE_SHIFT
+    frac = code & ((1 << TABLE_SHIFT) - 1)
+    return (table[i] + (table[i + 1] - table[i]) * frac / (1 << TABLE_SHIFT)) / 100.0
+
+
+def max_error(table, r25, b, series, lo, hi):
+    """逐码值比较查表与精确模型，返回区间 [lo, hi] °C 内的最大误差"""
+    worst = 0.0
+    for code in range(1, 65535):
+        t = exact_temp(code, r25, b, series)
+        if lo <= t <= hi:
+            worst = max(worst, abs(lookup(table, code) - t))
+    return worst
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--r25', type=float, default=10000.0, help='25 °C 时 NTC 阻值 (Ω)')
+    parser.add_argument('--b', type=float, default=3950.0, help='B 值')
+    parser.add_argument('--series', type=float, default=10000.0, help='分压串联电阻 (Ω)')
+    parser.add_argument('-o', '--output', default=os.path.join(os.path.dirname(os.path.abspath(__file__)), 'ntc_table.h'))
+    args = parser.parse_args()
+
+    table = build_table(args.r25, args.b, args.series)
+    errors = [(lo, hi, max_error(table, args.r25, args.b, args.series, lo, hi)) for lo, hi in REPORT_RANGES]
+
+    lines = [
+        '#ifndef NTC_TABLE_H',
+        '#define NTC_TABLE_H',
+        '',
+        '/*******************************************************************************',
+        ' * 由 gen_ntc_table.py 生成，请勿手工修改',
+        ' *',
+        f' *   R25 = {args.r25:g} Ω, B = {args.b:g}, 串联电阻 = {args.series:g} Ω',
+        f' *   {TABLE_SIZE} 个节点，每段 {1 << TABLE_SHIFT} 个码值，单位 0.01°C',
+        ' *',
+        ' * 查表（线性插值）相对精确模型的最大误差：',
+    ]
+    for lo, hi, err in errors:
+        lines.append(f' *   {lo:6.1f} ~ {hi:6.1f} °C : {err:.4f} °C')
+    lines += [
+        ' ******************************************************************************/',
+        '',
+        f'#define NTC_TABLE_R25           {args.r25:.1f}f',
+        f'#define NTC_TABLE_B_VALUE       {args.b:.1f}f',
+        f'#define NTC_TABLE_SERIES_R      {args.series:.1f}f',
+        '',
+        'static const int16_t ntc_default_table[NTC_TABLE_SIZE] = {',
+    ]
+    for i in range(0, TABLE_SIZE, 12):
+        lines.append('    ' + ' '.join(f'{v:6d},' for v in table[i:i + 12]))
+    lines += ['};', '', '#endif /* NTC_TABLE_H */', '']
+
+    with open(args.output, 'w', encoding='utf-8', newline='\n') as f:
+        f.write('\n'.join(lines))
+    print(f"Wrote {args.output}")
+    for lo, hi, err in errors:
+        print(f"  max error {lo:.0f}..{hi:.0f} C: {err:.4f} C")
+
+
+if __name__ == '__main__':
+    main()
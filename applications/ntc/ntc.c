@@ -0,0 +1,140 @@
+#include <math.h>
+#include <stdlib.h>
+#include "ntc.h"
+#include "ntc_table.h"
+
+/*******************************************************************************
+ * 参数定义
+ ******************************************************************************/
+#define NTC_ADC_FULL_SCALE  65535.0f
+
+static const int16_t *ntc_table = ntc_default_table;   // 当前使用的表
+static int16_t *ntc_ram_table = RT_NULL;                // 重建的表，使用默认表时为空
+static float ntc_r25 = NTC_TABLE_R25;
+static float ntc_b_value = NTC_TABLE_B_VALUE;
+static float ntc_series_r = NTC_TABLE_SERIES_R;
+
+/*******************************************************************************
+ * 函数定义
+ ******************************************************************************/
+static float ntc_model(uint32_t adc_val, float r25, float b_value, float series_r)
+{
+    float ratio = (float)adc_val / NTC_ADC_FULL_SCALE;
+    if (ratio <= 0.0f) return 327.67f;
+    if (ratio >= 1.0f) return -100.0f;
+    float r_ntc = series_r * ratio / (1.0f - ratio);
+    float t_kelvin = 1.0f / ((1.0f / 298.15f) + (logf(r_ntc / r25) / b_value));
+    return t_kelvin - 273.15f;
+}
+
+static int16_t to_centi(float value)
+{
+    float scaled = value * 100.0f;
+    if (scaled > 32767.0f) return 32767;
+    if (scaled < -32768.0f) return -32768;
+    return (int16_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+}
+
+/**
+ * @brief  按标定常数选择查找表，与生成默认表时的常数一致时直接使用 flash 中的表
+ */
+rt_err_t ntc_init(float r25, float b_value, float series_r)
+{
+    if (r25 == NTC_TABLE_R25 && b_value == NTC_TABLE_B_VALUE && series_r == NTC_TABLE_SERIES_R)
+        return RT_EOK;
+
+    rt_kprintf("[NTC] Calibration differs from ntc_table.h, rebuilding table in RAM.\n");
+    return ntc_table_build(r25, b_value, series_r);
+}
+
+/**
+ * @brief  按新的标定常数重建查找表
+ * @note   新表建好后整体切换指针，旧表随即释放；读者（PID线程）优先级高于调用方，
+ *         调用方运行时不可能有读者正停在旧表中间
+ */
+rt_err_t ntc_table_build(float r25, float b_value, float series_r)
+{
+    if (r25 <= 0.0f || b_value <= 0.0f || series_r <= 0.0f) return -RT_EINVAL;
+
+    int16_t *table = rt_malloc(NTC_TABLE_SIZE * sizeof(int16_t));
+    if (table == RT_NULL) return -RT_ENOMEM;
+    for (uint32_t i = 0; i < NTC_TABLE_SIZE; i++)
+        table[i] = to_centi(ntc_model(i << NTC_TABLE_SHIFT, r25, b_value, series_r));
+
+    int16_t *old = ntc_ram_table;
+    ntc_r25 = r25;
+    ntc_b_value = b_value;
+    ntc_series_r = series_r;
+    ntc_ram_table = table;
+    ntc_table = table;
+    if (old != RT_NULL) rt_free(old);
+    return RT_EOK;
+}
+
+/**
+ * @brief  ADC 码值 → 温度 (°C)，查表线性插值
+ * @note   满量程（开路）返回 -100，与原先的换算保持一致
+ */
+float ntc_adc_to_temp(uint32_t adc_val)
+{
+    if (adc_val >= 65535) return -100.0f;
+
+    const int16_t *t = ntc_table;
+    uint32_t i = adc_val >> NTC_TABLE_SHIFT;
+    int32_t frac = adc_val & ((1UL << NTC_TABLE_SHIFT) - 1);
+    int32_t centi = t[i] * (1L << NTC_TABLE_SHIFT) + (t[i + 1] - t[i]) * frac;
+    return (float)centi * (0.01f / (1UL << NTC_TABLE_SHIFT));
+}
+
+/**
+ * @brief  按当前标定常数精确计算温度 (°C)，用于误差评估
+ */
+float ntc_exact_temp(uint32_t adc_val)
+{
+    return ntc_model(adc_val, ntc_r25, ntc_b_value, ntc_series_r);
+}
+
+/**
+ * @brief  当前表在 [lo, hi] °C 区间内相对精确模型的最大误差
+ * @note   每 8 个码值比较一次，约 8000 次 logf
+ */
+float ntc_table_max_error(float lo, float hi)
+{
+    float worst = 0.0f;
+    for (uint32_t code = 1; code < 65535; code += 8)
+    {
+        float exact = ntc_exact_temp(code);
+        if (exact < lo || exact > hi) continue;
+        float err = fabsf(ntc_adc_to_temp(code) - exact);
+        if (err > worst) worst = err;
+    }
+    return worst;
+}
+
+/**
+ * @brief  MSH命令：查看或修改 NTC 标定常数
+ * @usage  ntc_cal [<r25> <b_value> <series_r>]
+ */
+void ntc_cal(int argc, char **argv)
+{
+    if (argc == 4)
+    {
+        rt_err_t result = ntc_table_build(atof(argv[1]), atof(argv[2]), atof(argv[3]));
+        if (result != RT_EOK)
+        {
+            rt_kprintf("Error: Rebuilding NTC table failed (%d).\n", result);
+            return;
+        }
+    }
+    else if (argc != 1)
+    {
+        rt_kprintf("Usage: ntc_cal [<r25> <b_value> <series_r>]\n");
+        return;
+    }
+
+    rt_kprintf("NTC: R25=%.1f ohm, B=%.1f, series=%.1f ohm (%s table)\n", ntc_r25, ntc_b_value, ntc_series_r,
+               ntc_ram_table != RT_NULL ? "RAM" : "built-in");
+    rt_kprintf("  Max table error   0~120 C: %.4f C\n", ntc_table_max_error(0.0f, 120.0f));
+    rt_kprintf("  Max table error -20~150 C: %.4f C\n", ntc_table_max_error(-20.0f, 150.0f));
+}
+MSH_CMD_EXPORT(ntc_cal, Show or change NTC calibration and table error);
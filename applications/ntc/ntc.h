@@ -0,0 +1,24 @@
+#ifndef NTC_H
+#define NTC_H
+
+/*******************************************************************************
+ * NTC 温度换算
+ *
+ * ADC 码值 → 温度用分段线性查找表完成，每次换算只需一次移位和一次乘法，
+ * 不再逐个采样计算 log()。默认表由 gen_ntc_table.py 离线生成（ntc_table.h），
+ * 标定常数与生成时不同时在 RAM 中重建。
+ ******************************************************************************/
+#include <rtthread.h>
+#include <stdint.h>
+
+#define NTC_ADC_BITS        16
+#define NTC_TABLE_SHIFT     7                                       // 每段 128 个码值
+#define NTC_TABLE_SIZE      ((1UL << NTC_ADC_BITS >> NTC_TABLE_SHIFT) + 1)
+
+rt_err_t ntc_init(float r25, float b_value, float series_r);
+rt_err_t ntc_table_build(float r25, float b_value, float series_r);
+float ntc_adc_to_temp(uint32_t adc_val);
+float ntc_exact_temp(uint32_t adc_val);
+float ntc_table_max_error(float lo, float hi);
+
+#endif /* NTC_H */
@@ -0,0 +1,66 @@
+#ifndef NTC_TABLE_H
+#define NTC_TABLE_H
+
+/*******************************************************************************
+ * 由 gen_ntc_table.py 生成，请勿手工修改
+ *
+ *   R25 = 10000 Ω, B = 3950, 串联电阻 = 10000 Ω
+ *   513 个节点，每段 128 个码值，单位 0.01°C
+ *
+ * 查表（线性插值）相对精确模型的最大误差：
+ *    -20.0 ~  150.0 °C : 0.0629 °C
+ *      0.0 ~  120.0 °C : 0.0181 °C
+ *     20.0 ~  100.0 °C : 0.0067 °C
+ ******************************************************************************/
+
+#define NTC_TABLE_R25           10000.0f
+#define NTC_TABLE_B_VALUE       3950.0f
+#define NTC_TABLE_SERIES_R      10000.0f
+
+static const int16_t ntc_default_table[NTC_TABLE_SIZE] = {
+     32767,  29017,  23936,  21363,  19685,  18459,  17502,  16722,  16067,  15503,  15011,  14574,
+     14182,  13828,  13504,  13207,  12932,  12677,  12439,  12215,  12006,  11808,  11620,  11443,
+     11274,  11113,  10959,  10812,  10671,  10536,  10406,  10281,  10160,  10044,   9931,   9822,
+      9717,   9615,   9516,   9419,   9326,   9235,   9147,   9060,   8976,   8895,   8815,   8737,
+      8660,   8586,   8513,   8442,   8372,   8304,   8237,   8171,   8107,   8044,   7982,   7921,
+      7862,   7803,   7745,   7689,   7633,   7578,   7524,   7471,   7419,   7368,   7317,   7267,
+      7218,   7170,   7122,   7075,   7028,   6983,   6937,   6893,   6849,   6805,   6762,   6720,
+      6678,   6636,   6596,   6555,   6515,   6476,   6436,   6398,   6360,   6322,   6284,   6247,
+      6211,   6174,   6138,   6103,   6068,   6033,   5998,   5964,   5930,   5896,   5863,   5830,
+      5797,   5765,   5733,   5701,   5669,   5638,   5607,   5576,   5545,   5515,   5485,   5455,
+      5425,   5396,   5367,   5338,   5309,   5280,   5252,   5224,   5196,   5168,   5141,   5113,
+      5086,   5059,   5032,   5005,   4979,   4952,   4926,   4900,   4874,   4849,   4823,   4798,
+      4772,   4747,   4722,   4698,   4673,   4648,   4624,   4600,   4575,   4551,   4527,   4504,
+      4480,   4457,   4433,   4410,   4387,   4364,   4341,   4318,   4295,   4272,   4250,   4227,
+      4205,   4183,   4161,   4139,   4117,   4095,   4073,   4051,   4030,   4008,   3987,   3966,
+      3944,   3923,   3902,   3881,   3860,   3839,   3819,   3798,   3777,   3757,   3736,   3716,
+      3696,   3675,   3655,   3635,   3615,   3595,   3575,   3555,   3535,   3516,   3496,   3476,
+      3457,   3437,   3418,   3398,   3379,   3360,   3341,   3321,   3302,   3283,   3264,   3245,
+      3226,   3207,   3189,   3170,   3151,   3132,   3114,   3095,   3076,   3058,   3039,   3021,
+      3003,   2984,   2966,   2948,   2929,   2911,   2893,   2875,   2857,   2838,   2820,   2802,
+      2784,   2766,   2748,   2730,   2713,   2695,   2677,   2659,   2641,   2624,   2606,   2588,
+      2570,   2553,   2535,   2518,   2500,   2482,   2465,   2447,   2430,   2412,   2395,   2377,
+      2360,   2342,   2325,   2308,   2290,   2273,   2256,   2238,   2221,   2204,   2186,   2169,
+      2152,   2134,   2117,   2100,   2083,   2065,   2048,   2031,   2014,   1997,   1979,   1962,
+      1945,   1928,   1910,   1893,   1876,   1859,   1842,   1825,   1807,   1790,   1773,   1756,
+      1739,   1721,   1704,   1687,   1670,   1652,   1635,   1618,   1601,   1583,   1566,   1549,
+      1532,   1514,   1497,   1480,   1462,   1445,   1428,   1410,   1393,   1376,   1358,   1341,
+      1323,   1306,   1288,   1271,   1253,   1236,   1218,   1201,   1183,   1165,   1148,   1130,
+      1112,   1095,   1077,   1059,   1041,   1024,   1006,    988,    970,    952,    934,    916,
+       898,    880,    862,    843,    825,    807,    789,    770,    752,    734,    715,    697,
+       678,    659,    641,    622,    603,    585,    566,    547,    528,    509,    490,    471,
+       452,    432,    413,    394,    374,    355,    335,    316,    296,    276,    257,    237,
+       217,    197,    177,    156,    136,    116,     95,     75,     54,     34,     13,     -8,
+       -29,    -50,    -71,    -92,   -114,   -135,   -157,   -178,   -200,   -222,   -244,   -266,
+      -289,   -311,   -333,   -356,   -379,   -402,   -425,   -448,   -471,   -495,   -518,   -542,
+      -566,   -590,   -614,   -639,   -663,   -688,   -713,   -738,   -764,   -789,   -815,   -841,
+      -867,   -893,   -920,   -947,   -974,  -1001,  -1028,  -1056,  -1084,  -1112,  -1141,  -1170,
+     -1199,  -1228,  -1258,  -1288,  -1319,  -1349,  -1380,  -1412,  -1444,  -1476,  -1508,  -1541,
+     -1575,  -1609,  -1643,  -1678,  -1713,  -1749,  -1785,  -1822,  -1859,  -1897,  -1936,  -1975,
+     -2015,  -2056,  -2097,  -2139,  -2182,  -2226,  -2271,  -2317,  -2363,  -2411,  -2459,  -2509,
+     -2560,  -2613,  -2667,  -2722,  -2779,  -2837,  -2897,  -2959,  -3024,  -3090,  -3159,  -3231,
+     -3305,  -3383,  -3464,  -3549,  -3638,  -3732,  -3832,  -3938,  -4051,  -4172,  -4303,  -4446,
+     -4604,  -4780,  -4979,  -5210,  -5485,  -5830,  -6297,  -7051, -10000,
+};
+
+#endif /* NTC_TABLE_H */
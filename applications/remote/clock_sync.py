@@ -0,0 +1,119 @@
+"""
+板端时钟到主机时间的映射
+
+状态帧的 timestamp_ms 是板端发布快照时的 rt_tick（ms），与网络延迟无关。
+代理周期性发送 time 命令，记录发出与收到回复的主机时刻 t0/t1，板端回复
+TIME <tick_ms>，按 NTP 的做法认为板端时刻对应往返中点 (t0 + t1)/2。
+窗口内取往返时间最短的一半样本，以最小二乘拟合
+    host = host_mean + rate · (board - board_mean)
+rate - 1 即晶振漂移。往返时间长的样本（Wi-Fi 重传、代理繁忙）不参与拟合。
+
+主机侧用 time.monotonic() 测量，换算为墙钟时只加当前的墙钟偏移，
+主机校时不会破坏拟合。
+"""
+import collections
+import time
+
+PROBE_PERIOD_S = 5.0        # 稳定后的探测周期
+PROBE_FAST_S = 0.25         # 刚连接时的探测周期，直到攒够 PROBE_FAST_COUNT 个样本
+PROBE_FAST_COUNT = 8
+WINDOW = 120                # 拟合窗口的样本数（约 10 分钟）
+MAX_DRIFT = 500e-6          # 漂移估计的合理范围，超出时视为拟合不可靠，只用偏移
+REBOOT_BACKSTEP_MS = 10000  # 板端时间倒退超过该值视为重启
+
+
+def host_now_ms():
+    return time.monotonic() * 1000.0
+
+
+class BoardClock:
+    def __init__(self):
+        self.reset()
+
+    def reset(self):
+        self.samples = collections.deque(maxlen=WINDOW)    # (board_ms, host_mid_ms, rtt_ms)
+        self.pending = collections.deque()                 # 已发出、尚未收到回复的探测时刻
+        self.last_raw = None                               # 上一个板端 32 位时间
+        self.last_ext = 0                                  # 展开后的板端时间
+        self.board_mean = 0.0
+        self.host_mean = 0.0
+        self.rate = 1.0
+        self.rtt_min = None
+        self.locked = False
+
+    def unwrap(self, board_ms):
+        """把 32 位毫秒计数展开为单调的 64 位值，检测到重启时清空拟合"""
+        board_ms &= 0xFFFFFFFF
+        if self.last_raw is None:
+            self.last_raw = board_ms
+            self.last_ext = board_ms
+            return board_ms
+        diff = (board_ms - self.last_raw) & 0xFFFFFFFF
+        if diff >= 0x80000000:
+            diff -= 0x100000000
+        if diff < -REBOOT_BACKSTEP_MS:
+            print("Board clock went backwards, assuming a reboot; resynchronising.")
+            pending = self.pending
+            self.reset()
+            self.pending = pending
+            self.last_raw = board_ms
+            self.last_ext = board_ms
+            return board_ms
+        # 推送帧的时间戳是快照时刻，可能比之前的 TIME 回复早几毫秒，不更新基准
+        if diff > 0:
+            self.last_raw = board_ms
+            self.last_ext += diff
+        return self.last_ext + min(diff, 0)
+
+    def probe_sent(self):
+        self.pending.append(host_now_ms())
+
+    def probe_interval(self):
+        return PROBE_FAST_S if len(self.samples) < PROBE_FAST_COUNT else PROBE_PERIOD_S
+
+    def on_reply(self, board_ms, t1=None):
+        """收到 TIME 回复（与探测一一对应、按序返回）"""
+        if not self.pending:
+            return
+        t0 = self.pending.popleft()
+        t1 = host_now_ms() if t1 is None else t1
+        board = self.unwrap(board_ms)
+        self.samples.append((board, 0.5 * (t0 + t1), t1 - t0))
+        self._fit()
+
+    def _fit(self):
+        best = sorted(self.samples, key=lambda s: s[2])[:max(len(self.samples) // 2, 1)]
+        self.rtt_min = best[0][2]
+        n = len(best)
+        bm = sum(s[0] for s in best) / n
+        hm = sum(s[1] for s in best) / n
+        sbb = sum((s[0] - bm) ** 2 for s in best)
+        rate = 1.0
+        if n >= 2 and sbb > 0.0:
+            rate = sum((s[0] - bm) * (s[1] - hm) for s in best) / sbb
+            if abs(rate - 1.0) > MAX_DRIFT:
+                rate = 1.0
+        self.board_mean = bm
+        self.host_mean = hm
+        self.rate = rate
+        self.locked = True
+
+    def to_host_ms(self, board_ms):
+        """板端时间戳 → 主机墙钟 (ms)；尚未同步时返回 None"""
+        if not self.locked:
+            return None
+        board = self.unwrap(board_ms)
+        mono = self.host_mean + self.rate * (board - self.board_mean)
+        return mono + (time.time() - time.monotonic()) * 1000.0
+
+    def stats(self):
+        if not self.locked:
+            return {"locked": False}
+        offset = self.host_mean + (time.time() - time.monotonic()) * 1000.0 - self.board_mean
+        return {
+            "locked": True,
+            "offset_ms": round(offset, 1),          # 主机墙钟 - 板端 tick（拟合窗口中心处）
+            "drift_ppm": round((self.rate - 1.0) * 1e6, 2),
+            "rtt_min_ms": round(self.rtt_min, 2),
+            "samples": len(self.samples),
+        }
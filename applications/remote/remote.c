@@ -1,19 +1,130 @@
 #include <rtthread.h>
 #include <sys/socket.h>
+#include <sys/select.h>
 #include <netdb.h>
 #include <string.h>
 #include <sys/errno.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdarg.h>
 #include "system_vars.h"
 #include "drv_pin.h"
+#include "telemetry.h"
+#include "status_frame.h"
 
-#define SERVER_PORT     5000    // 服务器监听的端口
+#define SERVER_PORT     5000    // 默认监听端口，remote_start <port> 可另行指定
 #define RECV_BUFSZ      256     // 接收缓冲区大小
-#define SEND_BUFSZ      630    // 发送缓冲区大小
+#define STATUS_LINE_MAX 1024    // 单条状态回复（JSON 行或二进制帧）的最大长度
+#define REPLY_BUFSZ     2048    // 每个连接的待发缓冲，至少容纳一条最长的状态回复
+#define REPLY_LINE_MAX  128     // 普通文本回复的最大长度
 #define MAX_ARGS        16      // 命令行参数最大数量
+#define MAX_CLIENTS     4       // 同时服务的客户端数，受 RT_LWIP_TCP_PCB_NUM 限制
+#define SEND_STALL_MS   2000    // 待发数据持续这么久没有进展时断开该连接
 
 static rt_thread_t server_thread = RT_NULL;
 
+/*******************************************************************************
+ * 状态字段表（get_status 与 subscribe 共用）
+ ******************************************************************************/
+typedef enum {
+    FIELD_F2 = 0,       // float，保留两位小数
+    FIELD_MS,           // 以秒存储的 float，按毫秒输出
+    FIELD_U32,          // rt_uint32_t
+    FIELD_STATE,        // control_state_t，输出状态名
+    FIELD_RELAY,        // 继电器加热侧标志，输出 "ON"/"OFF"
+    FIELD_MODE,         // control_mode_t，输出 "PID"/"MPC"
+    FIELD_FAULT         // rt_uint8_t 故障标志，输出 "OK"/"FAULT"
+} status_field_type_t;
+
+typedef struct {
+    const char *name;
+    rt_uint8_t type;
+    rt_uint16_t offset;     // 在 control_snapshot_t 中的偏移
+} status_field_t;
+
+#define SNAP_FIELD(name, type, member)  { name, type, offsetof(control_snapshot_t, member) }
+
+static const status_field_t status_fields[] = {
+    SNAP_FIELD("cycle",                   FIELD_U32,   cycle),
+    SNAP_FIELD("timestamp_ms",            FIELD_U32,   timestamp_ms),
+    SNAP_FIELD("current_ptc_temperature", FIELD_F2,    ptc_temperature),
+    SNAP_FIELD("current_temperature",     FIELD_F2,    current_temperature),
+    SNAP_FIELD("target_temperature",      FIELD_F2,    target_temperature),
+    SNAP_FIELD("ptc_target_temperature",  FIELD_F2,    ptc_target_temp),
+    SNAP_FIELD("current_humidity",        FIELD_F2,    current_humidity),
+    SNAP_FIELD("env_temperature",         FIELD_F2,    env_temperature),
+    SNAP_FIELD("ptc_state",               FIELD_RELAY, relay_heat),
+    SNAP_FIELD("control_state",           FIELD_STATE, state),
+    SNAP_FIELD("current_pwm",             FIELD_F2,    pwm_duty),
+    SNAP_FIELD("heat_kp",                 FIELD_F2,    pid_ptc.kp),
+    SNAP_FIELD("heat_ki",                 FIELD_F2,    pid_ptc.ki),
+    SNAP_FIELD("heat_kd",                 FIELD_F2,    pid_ptc.kd),
+    SNAP_FIELD("box_kp",                  FIELD_F2,    pid_box.kp),
+    SNAP_FIELD("box_ki",                  FIELD_F2,    pid_box.ki),
+    SNAP_FIELD("box_kd",                  FIELD_F2,    pid_box.kd),
+    SNAP_FIELD("cool_kp",                 FIELD_F2,    pid_cool.kp),
+    SNAP_FIELD("cool_ki",                 FIELD_F2,    pid_cool.ki),
+    SNAP_FIELD("warming_bias",            FIELD_F2,    warming_bias),
+    SNAP_FIELD("heating_bias",            FIELD_F2,    heating_bias),
+    SNAP_FIELD("warming_threshold",       FIELD_F2,    warming_threshold),
+    SNAP_FIELD("hysteresis_band",         FIELD_F2,    hysteresis_band),
+    SNAP_FIELD("ctrl_dt_ms",              FIELD_MS,    timing.dt_last),
+    SNAP_FIELD("ctrl_jitter_ms",          FIELD_MS,    timing.jitter_rms),
+    SNAP_FIELD("ctrl_dt_max_ms",          FIELD_MS,    timing.dt_max),
+    SNAP_FIELD("ctrl_overruns",           FIELD_U32,   timing.overruns),
+    SNAP_FIELD("control_mode",            FIELD_MODE,  mode),
+    SNAP_FIELD("ctrl_compute_ms",         FIELD_MS,    timing.compute_last),
+    SNAP_FIELD("ctrl_compute_max_ms",     FIELD_MS,    timing.compute_max),
+    SNAP_FIELD("ptc_sensor",              FIELD_FAULT, ptc_sensor_fault),
+};
+#define NUM_STATUS_FIELDS       (sizeof(status_fields) / sizeof(status_fields[0]))
+#define STATUS_FIELDS_ALL       ((rt_uint32_t)((1ULL << NUM_STATUS_FIELDS) - 1))
+#define STATUS_FIELDS_SEQ       0x03u   // cycle / timestamp_ms，推送帧总是携带
+#define STATUS_FIELDS_DEFAULT   (STATUS_FIELDS_ALL & ~STATUS_FIELDS_SEQ)   // get_status 的字段
+
+/* 状态输出格式，由 proto 命令协商 */
+typedef enum {
+    PROTO_JSON = 0,
+    PROTO_BIN
+} remote_proto_t;
+
+/*
+ * 每个连接的待发缓冲：同一批命令的回复合并后一次 send，减少小包与往返。
+ * 套接字为非阻塞，send 只发出一部分时剩余数据留在缓冲中等套接字可写，
+ * 服务器线程从不阻塞在某一个客户端上
+ */
+typedef struct {
+    int sock;
+    rt_uint16_t len;            // 待发字节数
+    rt_uint8_t error;           // 发送失败或缓冲溢出，连接随后关闭
+    rt_tick_t progress;         // 最近一次发出数据（或缓冲由空变为非空）的时刻
+    rt_align(RT_ALIGN_SIZE) char data[REPLY_BUFSZ];
+} remote_reply_t;
+
+/* 单个客户端连接状态 */
+typedef struct {
+    int sock;                   // -1 表示空闲
+    char rx_buf[RECV_BUFSZ];    // 未成行的接收数据
+    rt_uint16_t rx_len;
+    rt_uint8_t rx_discard;      // 正在丢弃超长行，直到下一个行结束符
+    rt_uint8_t proto;           // remote_proto_t
+    rt_uint8_t delta;           // 二进制模式下推送差分帧
+    rt_uint8_t have_last;       // last_rec 有效（对端已持有同一基准）
+    rt_uint8_t frames_since_key;
+    status_record_t last_rec;   // 上一帧内容，差分基准
+    rt_tick_t sub_period;       // 推送周期 (tick)，0 表示未订阅
+    rt_tick_t sub_next;         // 下一次推送时刻
+    rt_uint32_t sub_mask;       // 推送字段掩码
+    rt_uint32_t sub_last_cycle; // 上一帧对应的控制周期，避免重复推送同一周期
+    rt_uint32_t hist_next;      // history 下一条待写入的记录序号
+    rt_uint32_t hist_left;      // history 尚未写入发送缓冲的记录数
+    remote_reply_t tx;
+} remote_client_t;
+
+static remote_client_t *tune_txn_client = RT_NULL;   // 打开了 tune 事务的连接
+
 static const char *control_state_to_string(control_state_t state)
 {
     switch (state)
@@ -25,20 +136,513 @@ static const char *control_state_to_string(control_state_t state)
     }
 }
 
+/**
+ * @brief  按字段掩码把快照格式化为一行 JSON
+ * @return 长度，缓冲区不足时返回 -1
+ */
+static int format_status(char *buf, size_t size, const control_snapshot_t *snap, rt_uint32_t mask)
+{
+    const char *base = (const char *)snap;
+    size_t len = 0;
+    int n;
+
+    buf[len++] = '{';
+    for (rt_uint32_t i = 0; i < NUM_STATUS_FIELDS; i++)
+    {
+        if (!(mask & (1UL << i))) continue;
+
+        const status_field_t *f = &status_fields[i];
+        const char *sep = (len > 1) ? "," : "";
+        switch (f->type)
+        {
+        case FIELD_F2:
+            n = snprintf(buf + len, size - len, "%s\"%s\":%.2f", sep, f->name, *(const float *)(base + f->offset));
+            break;
+        case FIELD_MS:
+            n = snprintf(buf + len, size - len, "%s\"%s\":%.3f", sep, f->name, *(const float *)(base + f->offset) * 1000.0f);
+            break;
+        case FIELD_U32:
+            n = snprintf(buf + len, size - len, "%s\"%s\":%u", sep, f->name, (unsigned int)*(const rt_uint32_t *)(base + f->offset));
+            break;
+        case FIELD_STATE:
+            n = snprintf(buf + len, size - len, "%s\"%s\":\"%s\"", sep, f->name,
+                         control_state_to_string(*(const control_state_t *)(base + f->offset)));
+            break;
+        case FIELD_RELAY:
+            n = snprintf(buf + len, size - len, "%s\"%s\":\"%s\"", sep, f->name,
+                         *(const rt_uint8_t *)(base + f->offset) ? "ON" : "OFF");
+            break;
+        case FIELD_MODE:
+            n = snprintf(buf + len, size - len, "%s\"%s\":\"%s\"", sep, f->name,
+                         *(const rt_uint8_t *)(base + f->offset) == CONTROL_MODE_MPC ? "MPC" : "PID");
+            break;
+        case FIELD_FAULT:
+            n = snprintf(buf + len, size - len, "%s\"%s\":\"%s\"", sep, f->name,
+                         *(const rt_uint8_t *)(base + f->offset) ? "FAULT" : "OK");
+            break;
+        default:
+            n = 0;
+            break;
+        }
+        if (n < 0 || (size_t)n >= size - len) return -1;
+        len += n;
+    }
+    n = snprintf(buf + len, size - len, "}\r\n");
+    if (n < 0 || (size_t)n >= size - len) return -1;
+    return (int)(len + n);
+}
+
+/**
+ * @brief  解析字段列表，参数可以用空格或逗号分隔
+ * @return 字段掩码，出现未知字段时返回 0 并把字段名写入 *bad
+ */
+static rt_uint32_t parse_field_mask(int argc, char **argv, const char **bad)
+{
+    rt_uint32_t mask = 0;
+    for (int a = 0; a < argc; a++)
+    {
+        char *saveptr;
+        for (char *name = strtok_r(argv[a], ",", &saveptr); name != RT_NULL; name = strtok_r(RT_NULL, ",", &saveptr))
+        {
+            rt_uint32_t i;
+            for (i = 0; i < NUM_STATUS_FIELDS; i++)
+            {
+                if (strcmp(name, status_fields[i].name) == 0) break;
+            }
+            if (i == NUM_STATUS_FIELDS)
+            {
+                *bad = name;
+                return 0;
+            }
+            mask |= 1UL << i;
+        }
+    }
+    return mask;
+}
+
+/*******************************************************************************
+ * 响应缓冲
+ ******************************************************************************/
+static void reply_begin(remote_reply_t *reply, int sock)
+{
+    reply->sock = sock;
+    reply->len = 0;
+    reply->error = 0;
+    reply->progress = rt_tick_get();
+}
+
+static rt_size_t reply_space(const remote_reply_t *reply)
+{
+    return REPLY_BUFSZ - reply->len;
+}
+
+/**
+ * @brief  尽量发出缓冲中的回复，不阻塞
+ * @note   只发出一部分时剩余数据前移到缓冲头部，等套接字可写后继续
+ * @return 曾经发送失败时返回 -1
+ */
+static int reply_flush(remote_reply_t *reply)
+{
+    if (reply->len > 0 && !reply->error)
+    {
+        int ret = send(reply->sock, reply->data, reply->len, 0);
+        if (ret > 0)
+        {
+            reply->len -= ret;
+            if (reply->len > 0) memmove(reply->data, reply->data + ret, reply->len);
+            reply->progress = rt_tick_get();
+        }
+        else if (ret < 0 && errno != EWOULDBLOCK && errno != EAGAIN)
+        {
+            rt_kprintf("[Remote] Send response failed.\n");
+            reply->error = 1;
+        }
+    }
+    return reply->error ? -1 : 0;
+}
+
+/**
+ * @brief  预留 size 字节的写入空间，剩余空间不足时先尝试发出已有内容
+ * @note   size 不得超过 REPLY_BUFSZ；写完后用 reply_commit 提交实际长度。
+ *         调用方已按剩余空间限流，仍然放不下时按发送失败处理，连接随后关闭
+ */
+static char *reply_reserve(remote_reply_t *reply, rt_size_t size)
+{
+    if (reply_space(reply) < size) reply_flush(reply);
+    if (reply_space(reply) < size)
+    {
+        rt_kprintf("[Remote] Response buffer overflow.\n");
+        reply->error = 1;
+        reply->len = 0;
+    }
+    if (reply->len == 0) reply->progress = rt_tick_get();
+    return reply->data + reply->len;
+}
+
+static void reply_commit(remote_reply_t *reply, int len)
+{
+    if (len > 0) reply->len += len;
+}
+
+static void reply_write(remote_reply_t *reply, const void *data, rt_size_t size)
+{
+    rt_memcpy(reply_reserve(reply, size), data, size);
+    reply->len += size;
+}
+
+static void reply_printf(remote_reply_t *reply, const char *fmt, ...)
+{
+    va_list args;
+    char *buf = reply_reserve(reply, REPLY_LINE_MAX);
+
+    va_start(args, fmt);
+    int len = vsnprintf(buf, REPLY_LINE_MAX, fmt, args);
+    va_end(args);
+    if (len >= REPLY_LINE_MAX) len = REPLY_LINE_MAX - 1;
+    reply_commit(reply, len);
+}
+
+/**
+ * @brief  把尚未发送的 history 记录写入发送缓冲，缓冲满时留待套接字可写后继续
+ */
+static void history_fill(remote_client_t *client)
+{
+    remote_reply_t *reply = &client->tx;
+    telemetry_record_t rec;
+
+    while (client->hist_left > 0 && !reply->error)
+    {
+        if (reply_space(reply) < sizeof(rec)) reply_flush(reply);
+        if (reply_space(reply) < sizeof(rec)) break;
+
+        // 发送期间被覆盖的记录以全零占位，保证字节数与文本头一致
+        if (!telemetry_read(client->hist_next, &rec))
+            rt_memset(&rec, 0, sizeof(rec));
+        reply_write(reply, &rec, sizeof(rec));
+        client->hist_next++;
+        client->hist_left--;
+    }
+}
+
+/**
+ * @brief  发送 since_seq 之后的遥测记录
+ * @note   先发一行文本头 "HISTORY <first_seq> <count> <record_size>\r\n"，
+ *         随后紧跟 count 条二进制记录；first_seq 大于请求值说明中间部分已被覆盖。
+ *         记录由 history_fill 随发送缓冲腾出空间陆续写入，发完之前该连接不处理
+ *         后续命令也不推送订阅帧，保证字节流的顺序
+ */
+static void send_history(remote_client_t *client, rt_uint32_t since_seq)
+{
+    rt_uint32_t first_seq;
+    rt_uint32_t count = telemetry_range(since_seq, &first_seq);
+
+    reply_printf(&client->tx, "HISTORY %u %u %u\r\n",
+                 (unsigned int)first_seq, (unsigned int)count, (unsigned int)sizeof(telemetry_record_t));
+    client->hist_next = first_seq;
+    client->hist_left = count;
+    history_fill(client);
+}
+
+/**
+ * @brief  按客户端协商的格式编码一帧状态
+ * @param  allow_delta 为 RT_FALSE 时总是输出完整帧（get_status）
+ * @return 长度，失败时返回 -1
+ */
+static int encode_status(remote_client_t *client, char *buf, const control_snapshot_t *snap,
+                         rt_uint32_t mask, rt_bool_t allow_delta)
+{
+    if (client->proto == PROTO_JSON)
+    {
+        int len = format_status(buf, STATUS_LINE_MAX, snap, mask);
+        if (len < 0) rt_kprintf("[Remote] JSON buffer overflow detected\n");
+        return len;
+    }
+
+    status_record_t rec;
+    int len;
+    status_record_from_snapshot(&rec, snap);
+    if (allow_delta && client->delta && client->have_last && client->frames_since_key < STATUS_FRAME_KEY_INTERVAL)
+    {
+        len = status_frame_encode_delta((rt_uint8_t *)buf, &rec, &client->last_rec);
+        client->frames_since_key++;
+    }
+    else
+    {
+        len = status_frame_encode_full((rt_uint8_t *)buf, &rec);
+        client->frames_since_key = 0;
+    }
+    // 对端解码后以本帧为基准，之后的差分都相对它计算
+    client->last_rec = rec;
+    client->have_last = 1;
+    return len;
+}
+
+/**
+ * @brief  订阅到期时推送一帧
+ * @note   只有出现新的控制周期时才推送，帧内容来自该周期发布的快照。
+ *         正在发送 history 或发送缓冲积压时丢弃本次推送；差分基准只随实际
+ *         写入缓冲的帧更新，对端收到的差分帧总是基于它收到过的帧
+ */
+static void push_subscription(remote_client_t *client, remote_reply_t *reply)
+{
+    rt_tick_t now = rt_tick_get();
+    if (client->sub_period == 0 || (rt_int32_t)(now - client->sub_next) < 0) return;
+
+    client->sub_next += client->sub_period;
+    if ((rt_int32_t)(now - client->sub_next) >= 0) client->sub_next = now + client->sub_period; // 落后太多时重新对齐
+
+    if (client->hist_left > 0) return;
+    if (reply_space(reply) < STATUS_LINE_MAX) reply_flush(reply);
+    if (reply_space(reply) < STATUS_LINE_MAX) return;
+
+    control_snapshot_t snap;
+    control_snapshot_read(&snap);
+    if (snap.cycle == client->sub_last_cycle) return;
+    client->sub_last_cycle = snap.cycle;
+
+    char *buf = reply_reserve(reply, STATUS_LINE_MAX);
+    reply_commit(reply, encode_status(client, buf, &snap, client->sub_mask, RT_TRUE));
+}
+
+/**
+ * @brief  计算 select 超时：最近一个订阅推送时刻或待发数据的停滞期限，都没有时返回 RT_NULL（一直阻塞）
+ */
+static struct timeval *next_timeout(remote_client_t *clients, struct timeval *tv)
+{
+    rt_bool_t any = RT_FALSE;
+    rt_int32_t wait = 0;
+    rt_tick_t now = rt_tick_get();
+
+    for (int i = 0; i < MAX_CLIENTS; i++)
+    {
+        const remote_client_t *client = &clients[i];
+        if (client->sock < 0) continue;
+        for (int k = 0; k < 2; k++)
+        {
+            rt_tick_t deadline;
+            if (k == 0 && client->sub_period != 0) deadline = client->sub_next;
+            else if (k == 1 && client->tx.len > 0) deadline = client->tx.progress + rt_tick_from_millisecond(SEND_STALL_MS);
+            else continue;
+
+            rt_int32_t w = (rt_int32_t)(deadline - now);
+            if (w < 0) w = 0;
+            if (!any || w < wait) wait = w;
+            any = RT_TRUE;
+        }
+    }
+    if (!any) return RT_NULL;
+
+    tv->tv_sec = wait / RT_TICK_PER_SECOND;
+    tv->tv_usec = (wait % RT_TICK_PER_SECOND) * (1000000 / RT_TICK_PER_SECOND);
+    return tv;
+}
+
+/**
+ * @brief  执行一条命令，回复写入 reply
+ * @note   每条命令恰好产生一个回复（history 为文本头加其后的记录），
+ *         顺序与命令顺序一致，客户端可以连发多条命令再按序读取回复
+ */
+static void handle_command(remote_client_t *client, int argc, char **argv, remote_reply_t *reply)
+{
+    if (strcmp(argv[0], "get_status") == 0)
+    {
+        control_snapshot_t snap;
+        control_snapshot_read(&snap);
+
+        char *buf = reply_reserve(reply, STATUS_LINE_MAX);
+        int len = encode_status(client, buf, &snap, STATUS_FIELDS_DEFAULT, RT_FALSE);
+        if (len < 0)
+            reply_printf(reply, "ERROR: Status too long.\r\n");
+        else
+            reply_commit(reply, len);
+    }
+    else if (strcmp(argv[0], "subscribe") == 0)
+    {
+        // subscribe <period_ms> [fields]，period_ms 为 0 时取消订阅
+        if (argc < 2)
+        {
+            reply_printf(reply, "ERROR: Usage: subscribe <period_ms> [field,...]\r\n");
+            return;
+        }
+
+        rt_uint32_t period_ms = strtoul(argv[1], RT_NULL, 10);
+        rt_uint32_t mask = STATUS_FIELDS_DEFAULT;
+        if (argc > 2)
+        {
+            const char *bad = RT_NULL;
+            mask = parse_field_mask(argc - 2, &argv[2], &bad);
+            if (mask == 0)
+            {
+                reply_printf(reply, "ERROR: Unknown field '%s'.\r\n", bad);
+                return;
+            }
+        }
+
+        if (period_ms == 0)
+        {
+            client->sub_period = 0;
+        }
+        else
+        {
+            // 推送周期取控制周期的整数倍
+            if (period_ms < CONTROL_PERIOD_MS) period_ms = CONTROL_PERIOD_MS;
+            period_ms = (period_ms + CONTROL_PERIOD_MS / 2) / CONTROL_PERIOD_MS * CONTROL_PERIOD_MS;
+            client->sub_period = rt_tick_from_millisecond(period_ms);
+            client->sub_next = rt_tick_get();
+            client->sub_mask = mask | STATUS_FIELDS_SEQ;
+            client->sub_last_cycle = (rt_uint32_t)-1;
+        }
+        reply_printf(reply, "OK\r\n");
+    }
+    else if (strcmp(argv[0], "proto") == 0)
+    {
+        // proto <json|bin> [delta]，二进制帧为固定布局，不区分订阅字段
+        if (argc >= 2 && strcmp(argv[1], "json") == 0)
+        {
+            client->proto = PROTO_JSON;
+            reply_printf(reply, "OK PROTO json\r\n");
+        }
+        else if (argc >= 2 && strcmp(argv[1], "bin") == 0)
+        {
+            client->proto = PROTO_BIN;
+            client->delta = (argc >= 3 && strcmp(argv[2], "delta") == 0);
+            client->have_last = 0;
+            reply_printf(reply, "OK PROTO bin %d %u%s\r\n", STATUS_FRAME_VERSION,
+                         (unsigned int)sizeof(status_record_t), client->delta ? " delta" : "");
+        }
+        else
+        {
+            reply_printf(reply, "ERROR: Usage: proto <json|bin> [delta]\r\n");
+        }
+    }
+    else if (strcmp(argv[0], "time") == 0)
+    {
+        // 与状态帧 timestamp_ms 同一时钟，客户端按往返时间估计时钟偏移
+        reply_printf(reply, "TIME %u\r\n", (unsigned int)rt_tick_get_millisecond());
+    }
+    else if (strcmp(argv[0], "history") == 0)
+    {
+        rt_uint32_t since_seq = (argc > 1) ? strtoul(argv[1], RT_NULL, 10) : 0;
+        send_history(client, since_seq);
+    }
+    else if (strcmp(argv[0], "tune") == 0)
+    {
+        // 所有连接共用服务器线程，tune 事务的归属按连接另行记录
+        if (tune_txn_client != RT_NULL && tune_txn_client != client)
+        {
+            reply_printf(reply, "ERROR: Tune transaction held by another client.\r\n");
+            return;
+        }
+        // 不回显整屏状态，批量调参时串口输出不会拖慢响应
+        if (tune_apply(argc, argv) != RT_EOK)
+        {
+            reply_printf(reply, "ERROR: tune rejected '%s'.\r\n", argc > 1 ? argv[1] : "");
+            return;
+        }
+        if (strcmp(argv[1], "begin") == 0) tune_txn_client = client;
+        else if (strcmp(argv[1], "commit") == 0 || strcmp(argv[1], "abort") == 0) tune_txn_client = RT_NULL;
+        reply_printf(reply, "OK\r\n");
+    }
+    else
+    {
+        reply_printf(reply, "ERROR: Unknown command '%s'.\r\n", argv[0]);
+    }
+}
+
+static void client_close(remote_client_t *client)
+{
+    if (tune_txn_client == client)
+    {
+        // 断开时放弃未提交的调参事务
+        char *abort_argv[] = { "tune", "abort" };
+        tune_apply(2, abort_argv);
+        tune_txn_client = RT_NULL;
+    }
+    closesocket(client->sock);
+    client->sock = -1;
+}
+
+/**
+ * @brief  从接收缓冲中取出完整的命令行逐条执行，不完整的尾部留待下次 recv
+ * @note   '\n'、'\r' 或 "\r\n" 都视为行结束，空行忽略；
+ *         超过 RECV_BUFSZ 的行整行丢弃，直到下一个行结束符时回复一条错误。
+ *         发送缓冲放不下一条最长回复或 history 尚未发完时暂停，剩余命令留在
+ *         接收缓冲，等套接字可写后继续
+ * @return 发送失败时返回 -1
+ */
+static int client_process_lines(remote_client_t *client, remote_reply_t *reply)
+{
+    char *argv[MAX_ARGS]; // 用于存放分割后的命令参数指针
+    char *line = client->rx_buf;
+    char *end = client->rx_buf + client->rx_len;
+    rt_bool_t partial = RT_FALSE;   // 停在一行不完整的命令上
+
+    while (line < end && !reply->error && client->hist_left == 0)
+    {
+        if (reply_space(reply) < STATUS_LINE_MAX) reply_flush(reply);
+        if (reply_space(reply) < STATUS_LINE_MAX) break;
+
+        char *eol = line;
+        while (eol < end && *eol != '\n' && *eol != '\r') eol++;
+        if (eol == end)
+        {
+            partial = RT_TRUE;
+            break;
+        }
+        *eol = '\0';
+
+        if (client->rx_discard)
+        {
+            // 超长行的尾部
+            client->rx_discard = 0;
+            reply_printf(reply, "ERROR: Command too long.\r\n");
+            line = eol + 1;
+            continue;
+        }
+
+        // rt_kprintf("[Remote] Received command: '%s'\n", line);
+        int argc = 0;
+        char *saveptr; // for strtok_r
+        char *ptr = strtok_r(line, " \t", &saveptr);
+        while (ptr != NULL && argc < MAX_ARGS) {
+            argv[argc++] = ptr;
+            ptr = strtok_r(NULL, " \t", &saveptr);
+        }
+        if (argc > 0) handle_command(client, argc, argv, reply);
+        line = eol + 1;
+    }
+
+    client->rx_len = end - line;
+    if (client->rx_len > 0) memmove(client->rx_buf, line, client->rx_len);
+    if (partial && client->rx_len >= RECV_BUFSZ - 1)
+    {
+        // 整个缓冲区都没有行结束符，丢弃到下一个行结束符为止
+        rt_kprintf("[Remote] Command too long, discarded.\n");
+        client->rx_discard = 1;
+        client->rx_len = 0;
+    }
+    return reply->error ? -1 : 0;
+}
+
 /**
  * @brief TCP服务器线程入口函数
- * @param parameter 线程参数 (未使用)
+ * @note  单线程 select() 复用监听套接字与最多 MAX_CLIENTS 个非阻塞连接，
+ *        select 超时同时用作订阅推送的节拍；待发数据超过 SEND_STALL_MS
+ *        没有进展的连接被断开，一个卡住的客户端不会拖住其他连接
+ * @param parameter 监听端口
  */
 static void remote_server_thread_entry(void *parameter)
 {
+    int port = (int)(rt_ubase_t)parameter;
     int sock, connected;
     struct sockaddr_in server_addr, client_addr;
     socklen_t sin_size;
-    
-    char recv_buf[RECV_BUFSZ];
-    char send_buf[SEND_BUFSZ];
-    char *argv[MAX_ARGS]; // 用于存放分割后的命令参数指针
-    int argc;
+
+    static remote_client_t clients[MAX_CLIENTS];
+    fd_set readset, writeset;
+    struct timeval tv;
+
+    for (int i = 0; i < MAX_CLIENTS; i++) clients[i].sock = -1;
 
     if ((sock = socket(AF_INET, SOCK_STREAM, 0)) == -1)
     {
@@ -47,7 +651,7 @@ static void remote_server_thread_entry(void *parameter)
     }
 
     server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(SERVER_PORT);
+    server_addr.sin_port = htons(port);
     server_addr.sin_addr.s_addr = INADDR_ANY;
     rt_memset(&(server_addr.sin_zero), 0, sizeof(server_addr.sin_zero));
 
@@ -57,134 +661,104 @@ static void remote_server_thread_entry(void *parameter)
         goto __exit;
     }
 
-    if (listen(sock, 5) == -1)
+    if (listen(sock, MAX_CLIENTS) == -1)
     {
         rt_kprintf("[Remote] Listen error\n");
         goto __exit;
     }
 
-    rt_kprintf("[Remote] TCP Server waiting for client on port %d...\n", SERVER_PORT);
+    rt_kprintf("[Remote] TCP Server waiting for clients on port %d (max %d)...\n", port, MAX_CLIENTS);
 
     while (1)
     {
-        sin_size = sizeof(struct sockaddr_in);
-        
-        // 接受客户端连接 (阻塞)
-        connected = accept(sock, (struct sockaddr *)&client_addr, &sin_size);
-        if (connected < 0)
+        int maxfd = sock;
+        FD_ZERO(&readset);
+        FD_ZERO(&writeset);
+        FD_SET(sock, &readset);
+        for (int i = 0; i < MAX_CLIENTS; i++)
+        {
+            if (clients[i].sock < 0) continue;
+            // 回复积压导致接收缓冲被未处理的命令占满时先不读
+            if (clients[i].rx_len < RECV_BUFSZ - 1) FD_SET(clients[i].sock, &readset);
+            if (clients[i].tx.len > 0) FD_SET(clients[i].sock, &writeset);
+            if (clients[i].sock > maxfd) maxfd = clients[i].sock;
+        }
+
+        if (select(maxfd + 1, &readset, &writeset, RT_NULL, next_timeout(clients, &tv)) < 0)
         {
-            rt_kprintf("[Remote] Accept connection failed! errno = %d\n", errno);
+            rt_kprintf("[Remote] Select error! errno = %d\n", errno);
+            rt_thread_mdelay(100);
             continue;
         }
-        rt_kprintf("[Remote] Got a connection from (%s, %d)\n", inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port));
 
-        // 与客户端交互循环
-        while (1)
+        // 新连接
+        if (FD_ISSET(sock, &readset))
         {
-            int bytes_received = recv(connected, recv_buf, RECV_BUFSZ - 1, 0);
-            if (bytes_received <= 0)
+            sin_size = sizeof(struct sockaddr_in);
+            connected = accept(sock, (struct sockaddr *)&client_addr, &sin_size);
+            if (connected < 0)
             {
-                rt_kprintf("[Remote] Client disconnected or recv error.\n");
-                closesocket(connected);
-                break;
-            }
-
-            recv_buf[bytes_received] = '\0';
-            char* p = strpbrk(recv_buf, "\r\n");
-            if (p) *p = '\0'; 
-            // rt_kprintf("[Remote] Received command: '%s'\n", recv_buf);
-            argc = 0;
-            char *saveptr; // for strtok_r
-            char *ptr = strtok_r(recv_buf, " ", &saveptr);
-            while (ptr != NULL && argc < MAX_ARGS) {
-                argv[argc++] = ptr;
-                ptr = strtok_r(NULL, " ", &saveptr);
-            }
- 
-            if (argc == 0) {
-                continue; // 空命令
+                rt_kprintf("[Remote] Accept connection failed! errno = %d\n", errno);
             }
- 
-            // --- 根据第一个参数分发命令 ---
-            if (strcmp(argv[0], "get_status") == 0)
+            else
             {
-                const float fan_percent = final_pwm_duty * 100.0f;
-                const char *ptc_state_str = (ptc_state == HEAT) ? "ON" : "OFF";
-                const char *ctrl_state_str = control_state_to_string(control_state);
-
-                int len = snprintf(send_buf, sizeof(send_buf), "{"\
-                    "\"current_ptc_temperature\":%.2f,"\
-                    "\"current_temperature\":%.2f,"\
-                    "\"target_temperature\":%.2f,"\
-                    "\"ptc_target_temperature\":%.2f,"\
-                    "\"current_humidity\":%.2f,"\
-                    "\"env_temperature\":%.2f,"\
-                    "\"ptc_state\":\"%s\","\
-                    "\"control_state\":\"%s\","\
-                    "\"current_pwm\":%.2f,"\
-                    "\"heat_kp\":%.2f,"\
-                    "\"heat_ki\":%.2f,"\
-                    "\"heat_kd\":%.2f,"\
-                    "\"box_kp\":%.2f,"\
-                    "\"box_ki\":%.2f,"\
-                    "\"box_kd\":%.2f,"\
-                    "\"cool_kp\":%.2f,"\
-                    "\"cool_ki\":%.2f,"\
-                    "\"warming_bias\":%.2f,"\
-                    "\"heating_bias\":%.2f,"\
-                    "\"warming_threshold\":%.2f,"\
-                    "\"hysteresis_band\":%.2f"\
-                    "}\r\n",
-                    ptc_temperature,
-                    current_temperature,
-                    target_temperature,
-                    ptc_target_temp,
-                    current_humidity,
-                    env_temperature,
-                    ptc_state_str,
-                    ctrl_state_str,
-                    final_pwm_duty,
-                    pid_ptc.kp,
-                    pid_ptc.ki,
-                    pid_ptc.kd,
-                    pid_box.kp,
-                    pid_box.ki,
-                    pid_box.kd,
-                    pid_cool.kp,
-                    pid_cool.ki,
-                    warming_bias,
-                    heating_bias,
-                    warming_threshold,
-                    hysteresis_band
-                );
-
-                if (len < 0 || len >= SEND_BUFSZ)
+                remote_client_t *client = RT_NULL;
+                for (int i = 0; i < MAX_CLIENTS && client == RT_NULL; i++)
                 {
-                    rt_kprintf("[Remote] JSON buffer overflow detected\n");
-                    continue;
+                    if (clients[i].sock < 0) client = &clients[i];
                 }
-
-                // 发送响应
-                if (send(connected, send_buf, (size_t)len, 0) < 0) {
-                    rt_kprintf("[Remote] Send response failed.\n");
+                if (client == RT_NULL)
+                {
+                    const char busy_msg[] = "ERROR: Too many clients.\r\n";
+                    send(connected, busy_msg, sizeof(busy_msg) - 1, 0);
                     closesocket(connected);
-                    break;
+                    rt_kprintf("[Remote] Rejected connection from %s, no free slot.\n", inet_ntoa(client_addr.sin_addr));
+                }
+                else
+                {
+                    fcntl(connected, F_SETFL, fcntl(connected, F_GETFL, 0) | O_NONBLOCK);
+                    rt_memset(client, 0, sizeof(*client));
+                    client->sock = connected;
+                    reply_begin(&client->tx, connected);
+                    rt_kprintf("[Remote] Got a connection from (%s, %d)\n", inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port));
                 }
             }
-            else if (strcmp(argv[0], "tune") == 0)
-            {         
-                tune(argc, argv);
+        }
 
-                const char ok_msg[] = "OK\r\n";
-                send(connected, ok_msg, sizeof(ok_msg) - 1, 0);
-            }
-            else
+        // 客户端数据、积压的输出与订阅推送
+        for (int i = 0; i < MAX_CLIENTS; i++)
+        {
+            remote_client_t *client = &clients[i];
+            if (client->sock < 0) continue;
+
+            if (FD_ISSET(client->sock, &readset))
             {
-                sprintf(send_buf, "ERROR: Unknown command '%s'.\r\n", argv[0]);
-                send(connected, send_buf, strlen(send_buf), 0);
+                int bytes_received = recv(client->sock, client->rx_buf + client->rx_len, RECV_BUFSZ - 1 - client->rx_len, 0);
+                if (bytes_received == 0 || (bytes_received < 0 && errno != EWOULDBLOCK && errno != EAGAIN))
+                {
+                    rt_kprintf("[Remote] Client disconnected or recv error.\n");
+                    client_close(client);
+                    continue;
+                }
+                if (bytes_received > 0) client->rx_len += bytes_received;
             }
 
-            rt_thread_mdelay(30);
+            // 先续发积压的回复和 history，再处理命令，最后推送；本轮的输出合并成一次 send
+            reply_flush(&client->tx);
+            history_fill(client);
+            client_process_lines(client, &client->tx);
+            push_subscription(client, &client->tx);
+            if (reply_flush(&client->tx) < 0)
+            {
+                client_close(client);
+            }
+            else if (client->tx.len > 0 &&
+                     rt_tick_get() - client->tx.progress >= rt_tick_from_millisecond(SEND_STALL_MS))
+            {
+                rt_kprintf("[Remote] Client stalled for %d ms with %u bytes pending, closing.\n",
+                           SEND_STALL_MS, (unsigned int)client->tx.len);
+                client_close(client);
+            }
         }
     }
 
@@ -195,6 +769,7 @@ __exit:
 
 /**
  * @brief MSH命令，用于启动远程控制服务器线程
+ * @usage remote_start [port]
  */
 
 void remote_start(int argc, char **argv)
@@ -205,9 +780,16 @@ void remote_start(int argc, char **argv)
         return;
     }
 
+    int port = (argc > 1) ? atoi(argv[1]) : SERVER_PORT;
+    if (port <= 0 || port > 65535)
+    {
+        rt_kprintf("Usage: remote_start [port]\n");
+        return;
+    }
+
     server_thread = rt_thread_create("RemoteTCPSrv",
                                      remote_server_thread_entry,
-                                     RT_NULL,
+                                     (void *)(rt_ubase_t)port,
                                      3172,
                                      11,
                                      30);
@@ -223,4 +805,3 @@ void remote_start(int argc, char **argv)
     }
 }
 MSH_CMD_EXPORT(remote_start, Start the remote control TCP server);
-
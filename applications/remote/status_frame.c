@@ -0,0 +1,120 @@
+#include <string.h>
+#include "status_frame.h"
+
+/*******************************************************************************
+ * 函数定义
+ ******************************************************************************/
+static rt_int16_t to_centi(float value)
+{
+    float scaled = value * 100.0f;
+    if (scaled > 32767.0f) return 32767;
+    if (scaled < -32768.0f) return -32768;
+    return (rt_int16_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+}
+
+static rt_uint16_t to_u16(float value)
+{
+    if (value > 65535.0f) return 65535;
+    if (value < 0.0f) return 0;
+    return (rt_uint16_t)(value + 0.5f);
+}
+
+void status_record_from_snapshot(status_record_t *rec, const control_snapshot_t *snap)
+{
+    rec->cycle = snap->cycle;
+    rec->timestamp_ms = snap->timestamp_ms;
+    rec->ptc_temp = to_centi(snap->ptc_temperature);
+    rec->box_temp = to_centi(snap->current_temperature);
+    rec->target_temp = to_centi(snap->target_temperature);
+    rec->ptc_target_temp = to_centi(snap->ptc_target_temp);
+    rec->env_temp = to_centi(snap->env_temperature);
+    rec->humidity = to_u16(snap->current_humidity * 100.0f);
+    rec->duty = to_u16(snap->pwm_duty * 10000.0f);
+    rec->state = (rt_uint8_t)snap->state;
+    rec->flags = (snap->relay_heat ? 0x01 : 0) | (snap->mode == CONTROL_MODE_MPC ? 0x02 : 0)
+               | (snap->ptc_sensor_fault ? 0x04 : 0);
+    rec->heat_kp = snap->pid_ptc.kp;
+    rec->heat_ki = snap->pid_ptc.ki;
+    rec->heat_kd = snap->pid_ptc.kd;
+    rec->box_kp = snap->pid_box.kp;
+    rec->box_ki = snap->pid_box.ki;
+    rec->box_kd = snap->pid_box.kd;
+    rec->cool_kp = snap->pid_cool.kp;
+    rec->cool_ki = snap->pid_cool.ki;
+    rec->warming_bias = to_centi(snap->warming_bias);
+    rec->heating_bias = to_centi(snap->heating_bias);
+    rec->warming_threshold = to_centi(snap->warming_threshold);
+    rec->hysteresis_band = to_centi(snap->hysteresis_band);
+    rec->dt_10us = to_u16(snap->timing.dt_last * 1e5f);
+    rec->jitter_us = to_u16(snap->timing.jitter_rms * 1e6f);
+    rec->dt_max_10us = to_u16(snap->timing.dt_max * 1e5f);
+    rec->overruns = snap->timing.overruns > 65535 ? 65535 : (rt_uint16_t)snap->timing.overruns;
+}
+
+/**
+ * @brief  CRC16-CCITT (多项式 0x1021，初值 0xFFFF)
+ * @note   帧长不足 100 字节，逐位计算即可，省去 512 字节查表
+ */
+rt_uint16_t status_frame_crc16(const rt_uint8_t *data, rt_size_t len)
+{
+    rt_uint16_t crc = 0xFFFF;
+    while (len--)
+    {
+        crc ^= (rt_uint16_t)(*data++) << 8;
+        for (int i = 0; i < 8; i++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+    return crc;
+}
+
+static int frame_finish(rt_uint8_t *buf, rt_uint8_t type, rt_uint16_t payload_len)
+{
+    buf[0] = STATUS_FRAME_MAGIC0;
+    buf[1] = STATUS_FRAME_MAGIC1;
+    buf[2] = STATUS_FRAME_VERSION;
+    buf[3] = type;
+    buf[4] = payload_len & 0xFF;
+    buf[5] = payload_len >> 8;
+
+    rt_size_t len = STATUS_FRAME_HEADER_SIZE + payload_len;
+    rt_uint16_t crc = status_frame_crc16(buf, len);
+    buf[len] = crc & 0xFF;
+    buf[len + 1] = crc >> 8;
+    return (int)(len + STATUS_FRAME_CRC_SIZE);
+}
+
+/**
+ * @brief  编码完整帧
+ * @param  buf 至少 STATUS_FRAME_MAX_SIZE 字节
+ * @return 帧长度
+ */
+int status_frame_encode_full(rt_uint8_t *buf, const status_record_t *rec)
+{
+    memcpy(buf + STATUS_FRAME_HEADER_SIZE, rec, sizeof(*rec));   // Cortex-M 为小端，直接拷贝
+    return frame_finish(buf, STATUS_FRAME_FULL, sizeof(*rec));
+}
+
+/**
+ * @brief  编码相对 prev 的差分帧
+ * @note   负载为变化位图（第 i 位对应记录的第 i 个 16 位字），随后按顺序列出变化的字
+ * @return 帧长度
+ */
+int status_frame_encode_delta(rt_uint8_t *buf, const status_record_t *rec, const status_record_t *prev)
+{
+    const rt_uint8_t *cur = (const rt_uint8_t *)rec;
+    const rt_uint8_t *old = (const rt_uint8_t *)prev;
+    rt_uint8_t *mask = buf + STATUS_FRAME_HEADER_SIZE;
+    rt_uint8_t *out = mask + STATUS_DELTA_MASK_SIZE;
+
+    memset(mask, 0, STATUS_DELTA_MASK_SIZE);
+    for (rt_size_t i = 0; i < STATUS_RECORD_WORDS; i++)
+    {
+        if (cur[2 * i] != old[2 * i] || cur[2 * i + 1] != old[2 * i + 1])
+        {
+            mask[i / 8] |= 1u << (i % 8);
+            *out++ = cur[2 * i];
+            *out++ = cur[2 * i + 1];
+        }
+    }
+    return frame_finish(buf, STATUS_FRAME_DELTA, (rt_uint16_t)(out - mask));
+}
@@ -0,0 +1,62 @@
+#ifndef STATUS_FRAME_H
+#define STATUS_FRAME_H
+
+/*******************************************************************************
+ * 二进制状态帧（JSON get_status 的紧凑替代，由 proto 命令协商）
+ *
+ *   帧头  : 0xA5 0x5A | version(1B) | type(1B) | payload_len(2B)
+ *   负载  : FULL  —— 完整 status_record_t
+ *           DELTA —— 变化位图 + 按 16 位字列出的变化内容（相对上一帧）
+ *   帧尾  : CRC16-CCITT(2B)，覆盖帧头与负载
+ *
+ * 所有多字节字段均为小端；上位机解码器见 websocket_proxy.py。
+ ******************************************************************************/
+#include <rtthread.h>
+#include "control.h"
+
+#define STATUS_FRAME_MAGIC0         0xA5
+#define STATUS_FRAME_MAGIC1         0x5A
+#define STATUS_FRAME_VERSION        1
+#define STATUS_FRAME_FULL           0x01
+#define STATUS_FRAME_DELTA          0x02
+#define STATUS_FRAME_HEADER_SIZE    6
+#define STATUS_FRAME_CRC_SIZE       2
+#define STATUS_FRAME_KEY_INTERVAL   50      // 差分模式下每隔多少帧插入一个完整帧，用于重新同步
+
+/* 状态记录，自然对齐、无填充，共 72 字节 */
+typedef struct {
+    rt_uint32_t cycle;                // 控制周期序号
+    rt_uint32_t timestamp_ms;         // 发布时刻 (ms)
+    rt_int16_t ptc_temp;              // PTC温度 (0.01°C)
+    rt_int16_t box_temp;              // 箱内温度 (0.01°C)
+    rt_int16_t target_temp;           // 目标温度 (0.01°C)
+    rt_int16_t ptc_target_temp;       // PTC目标温度 (0.01°C)
+    rt_int16_t env_temp;              // 环境温度 (0.01°C)
+    rt_uint16_t humidity;             // 湿度 (0.01%)
+    rt_uint16_t duty;                 // 占空比 (0.01%)
+    rt_uint8_t state;                 // control_state_t
+    rt_uint8_t flags;                 // bit0: 继电器处于加热侧，bit1: MPC 模式，bit2: PTC传感器故障
+    float heat_kp, heat_ki, heat_kd;  // 内环PID
+    float box_kp, box_ki, box_kd;     // 外环PID
+    float cool_kp, cool_ki;           // 风扇 PI
+    rt_int16_t warming_bias;          // (0.01°C)
+    rt_int16_t heating_bias;          // (0.01°C)
+    rt_int16_t warming_threshold;     // (0.01°C)
+    rt_int16_t hysteresis_band;       // (0.01°C)
+    rt_uint16_t dt_10us;              // 最近一次控制周期 (10 us)
+    rt_uint16_t jitter_us;            // 周期抖动均方根 (us)
+    rt_uint16_t dt_max_10us;          // 最大控制周期 (10 us)
+    rt_uint16_t overruns;             // 错过的定时节拍数（饱和到 65535）
+} status_record_t;
+
+#define STATUS_RECORD_WORDS         (sizeof(status_record_t) / 2)
+#define STATUS_DELTA_MASK_SIZE      ((STATUS_RECORD_WORDS + 7) / 8)
+#define STATUS_FRAME_MAX_SIZE       (STATUS_FRAME_HEADER_SIZE + STATUS_DELTA_MASK_SIZE + \
+                                     sizeof(status_record_t) + STATUS_FRAME_CRC_SIZE)
+
+void status_record_from_snapshot(status_record_t *rec, const control_snapshot_t *snap);
+int status_frame_encode_full(rt_uint8_t *buf, const status_record_t *rec);
+int status_frame_encode_delta(rt_uint8_t *buf, const status_record_t *rec, const status_record_t *prev);
+rt_uint16_t status_frame_crc16(const rt_uint8_t *data, rt_size_t len);
+
+#endif /* STATUS_FRAME_H */
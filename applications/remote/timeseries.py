@@ -0,0 +1,333 @@
+"""
+代理端时间序列存储：只追加、内存映射、按列存放
+
+每一级数据（原始样本、1 s、1 min、15 min 聚合）由若干段文件组成，段文件容量固定，
+写满后新开一段，从不改写已写入的行：
+
+    <dir>/<tier>-<段序号>.ts
+    [64 字节文件头][列0 × capacity][列1 × capacity]...
+
+原始样本的列为 t（样本时刻，主机墙钟 ms，float64）与每个字段一列 float32；
+聚合级的列为 t（桶起点）、n（样本数），每个字段 open/high/low/close/mean 五列。
+open/close 供面板直接画K线，min/max/mean 用于任意缩放级别的包络。
+
+写入顺序为先写行、再更新文件头的行数，进程中途退出时最多丢失未刷盘的尾部；
+正在累积的聚合桶只在内存中，查询时一并返回。
+"""
+import bisect
+import glob
+import math
+import mmap
+import os
+import struct
+
+# 落盘的字段，与 websocket_proxy.record_to_status 的键一致
+FIELDS = [
+    "current_temperature",
+    "current_ptc_temperature",
+    "target_temperature",
+    "ptc_target_temperature",
+    "env_temperature",
+    "current_humidity",
+    "current_pwm",
+]
+
+# (名称, 桶宽 ms, 每段行数)；桶宽 0 为原始样本。10 Hz 推送时一段原始样本约 7 小时
+TIERS = [
+    ("raw", 0, 1 << 18),
+    ("1s", 1000, 1 << 16),
+    ("1m", 60 * 1000, 1 << 14),
+    ("15m", 15 * 60 * 1000, 1 << 12),
+]
+
+AGGREGATES = ("open", "high", "low", "close", "mean")
+
+# 单次查询返回的桶数上限，超出时自动放宽桶宽
+MAX_QUERY_POINTS = 4000
+
+SEGMENT_MAGIC = b"LTCT"
+SEGMENT_VERSION = 1
+SEGMENT_HEADER = struct.Struct("<4sHHIIq40x")   # magic, version, 列数, capacity, count, 桶宽 ms
+COUNT_OFFSET = 12                               # 文件头中 count 的偏移
+
+
+def tier_columns(period_ms):
+    """返回一级数据的列定义 [(名称, struct 格式)]，float64 列在前以保持对齐"""
+    if period_ms == 0:
+        return [("t", "d")] + [(f, "f") for f in FIELDS]
+    columns = [("t", "d"), ("n", "I")]
+    for f in FIELDS:
+        columns += [(f"{f}.{a}", "f") for a in AGGREGATES]
+    return columns
+
+
+class Segment:
+    """一个段文件，列以 memoryview 的形式直接映射到文件"""
+
+    def __init__(self, path, columns, capacity, period_ms, create):
+        self.path = path
+        size = SEGMENT_HEADER.size + capacity * sum(struct.calcsize(fmt) for _, fmt in columns)
+        if create:
+            with open(path, "wb") as f:
+                f.write(SEGMENT_HEADER.pack(SEGMENT_MAGIC, SEGMENT_VERSION, len(columns), capacity, 0, period_ms))
+                f.truncate(size)
+        self.file = open(path, "r+b")
+        self.map = mmap.mmap(self.file.fileno(), size)
+        magic, version, ncols, cap, count, period = SEGMENT_HEADER.unpack_from(self.map)
+        if magic != SEGMENT_MAGIC or version != SEGMENT_VERSION or ncols != len(columns) \
+                or cap != capacity or period != period_ms:
+            self.close()
+            raise ValueError(f"{path}: incompatible segment header")
+        self.capacity = capacity
+        self.count = count
+        self.columns = {}
+        offset = SEGMENT_HEADER.size
+        view = memoryview(self.map)
+        for name, fmt in columns:
+            nbytes = capacity * struct.calcsize(fmt)
+            self.columns[name] = view[offset:offset + nbytes].cast(fmt)
+            offset += nbytes
+
+    def append(self, row):
+        i = self.count
+        for name, value in row.items():
+            self.columns[name][i] = value
+        self.count = i + 1
+        struct.pack_into("<I", self.map, COUNT_OFFSET, self.count)
+
+    def full(self):
+        return self.count >= self.capacity
+
+    def first_time(self):
+        return self.columns["t"][0] if self.count else math.inf
+
+    def flush(self):
+        self.map.flush()
+
+    def close(self):
+        for col in getattr(self, "columns", {}).values():
+            col.release()
+        self.columns = {}
+        self.map.close()
+        self.file.close()
+
+
+class Tier:
+    """同一级数据的全部段文件，以及正在累积的聚合桶"""
+
+    def __init__(self, directory, name, period_ms, capacity):
+        self.directory = directory
+        self.name = name
+        self.period_ms = period_ms
+        self.capacity = capacity
+        self.columns = tier_columns(period_ms)
+        self.segments = []
+        for path in sorted(glob.glob(os.path.join(directory, f"{name}-*.ts"))):
+            try:
+                seg = Segment(path, self.columns, capacity, period_ms, create=False)
+            except ValueError as e:
+                print(f"Skipping history segment: {e}")
+                continue
+            if seg.count:
+                self.segments.append(seg)
+            else:
+                seg.close()
+        self.bucket = None      # 正在累积的桶：dict(t, n, 各字段 open/high/low/close/sum)
+
+    def _writable(self):
+        if not self.segments or self.segments[-1].full():
+            index = int(os.path.basename(self.segments[-1].path).split("-")[1].split(".")[0]) + 1 \
+                if self.segments else 0
+            path = os.path.join(self.directory, f"{self.name}-{index:06d}.ts")
+            self.segments.append(Segment(path, self.columns, self.capacity, self.period_ms, create=True))
+        return self.segments[-1]
+
+    def first_time(self):
+        """最早一行的时刻（聚合级为桶起点），没有数据时返回 inf"""
+        if self.segments and self.segments[0].count:
+            return self.segments[0].first_time()
+        return self.bucket["t"] if self.bucket is not None else math.inf
+
+    def last_before(self, t_ms):
+        """早于 t_ms 的最后一行的时刻，没有时返回 None"""
+        b = self.bucket
+        if b is not None and b["t"] < t_ms:
+            return b["t"]       # 正在累积的桶总是最新的一行
+        firsts = [seg.first_time() for seg in self.segments]
+        k = bisect.bisect_left(firsts, t_ms) - 1
+        if k < 0:
+            return None
+        seg = self.segments[k]
+        t = seg.columns["t"][:seg.count]
+        return t[bisect.bisect_left(t, t_ms) - 1]
+
+    def last_time(self):
+        if not self.segments:
+            return -math.inf
+        seg = self.segments[-1]
+        return seg.columns["t"][seg.count - 1]
+
+    def add(self, t_ms, values):
+        """送入一个样本；跨入新桶时把上一个桶写入段文件"""
+        if self.period_ms == 0:
+            row = {"t": t_ms}
+            row.update(values)
+            self._writable().append(row)
+            return
+        start = t_ms - t_ms % self.period_ms
+        b = self.bucket
+        if b is not None and b["t"] != start:
+            self._writable().append(self._bucket_row(b))
+            b = None
+        if b is None:
+            b = self.bucket = {"t": start, "n": 0}
+            for f, v in values.items():
+                b[f] = [v, v, v, v, 0.0]
+        b["n"] += 1
+        for f, v in values.items():
+            agg = b[f]
+            if v > agg[1]: agg[1] = v
+            if v < agg[2]: agg[2] = v
+            agg[3] = v
+            agg[4] += v
+
+    @staticmethod
+    def _bucket_row(b):
+        row = {"t": b["t"], "n": b["n"]}
+        for f in FIELDS:
+            o, h, l, c, s = b[f]
+            row[f"{f}.open"] = o
+            row[f"{f}.high"] = h
+            row[f"{f}.low"] = l
+            row[f"{f}.close"] = c
+            row[f"{f}.mean"] = s / b["n"]
+        return row
+
+    def rows(self, field, start_ms, end_ms):
+        """按时间顺序产生 [start_ms, end_ms) 内的 (t, n, open, high, low, close, mean)"""
+        firsts = [seg.first_time() for seg in self.segments]
+        first = max(bisect.bisect_right(firsts, start_ms) - 1, 0)
+        for seg in self.segments[first:]:
+            t = seg.columns["t"][:seg.count]
+            if t[0] >= end_ms:
+                break
+            lo = bisect.bisect_left(t, start_ms)
+            hi = bisect.bisect_left(t, end_ms)
+            if self.period_ms == 0:
+                v = seg.columns[field]
+                for i in range(lo, hi):
+                    x = v[i]
+                    yield t[i], 1, x, x, x, x, x
+            else:
+                n = seg.columns["n"]
+                cols = [seg.columns[f"{field}.{a}"] for a in AGGREGATES]
+                for i in range(lo, hi):
+                    yield (t[i], n[i]) + tuple(c[i] for c in cols)
+        b = self.bucket
+        if b is not None and start_ms <= b["t"] < end_ms:
+            o, h, l, c, s = b[field]
+            yield b["t"], b["n"], o, h, l, c, s / b["n"]
+
+    def flush(self):
+        if self.segments:
+            self.segments[-1].flush()
+
+    def close(self):
+        for seg in self.segments:
+            seg.close()
+        self.segments = []
+
+
+class TimeSeriesStore:
+    """
+    代理端历史数据。append() 每收到一个状态样本调用一次，
+    query() 按任意时间范围与桶宽返回 K 线与包络，供面板缩放与重新加载时使用。
+    """
+
+    def __init__(self, directory):
+        os.makedirs(directory, exist_ok=True)
+        self.tiers = [Tier(directory, name, period, cap) for name, period, cap in TIERS]
+        self.last_t = max(tier.last_time() for tier in self.tiers)
+
+    def append(self, t_ms, status):
+        values = {}
+        for f in FIELDS:
+            v = status.get(f)
+            if isinstance(v, (int, float)):
+                values[f] = float(v)
+        if len(values) != len(FIELDS):
+            return
+        # 时间列必须单调，代理时钟回拨时丢弃样本
+        if t_ms <= self.last_t:
+            return
+        self.last_t = t_ms
+        for tier in self.tiers:
+            tier.add(t_ms, values)
+
+    def query(self, field, start_ms, end_ms, bucket_ms, limit=MAX_QUERY_POINTS):
+        """
+        返回 [start_ms, end_ms) 内以 bucket_ms 为桶宽的聚合：
+        {"field", "bucket", "tier", "start", "first", "before", "t", "open", "high", "low", "close", "mean"}。
+        从桶宽不大于 bucket_ms 的最粗一级读取，再合并成所需桶宽；
+        桶数超过 limit 时按比例放宽桶宽。start 为对齐后的起点，first 为该级最早一行的时刻，
+        before 为早于 start 的最后一行的时刻（没有时为 None），面板据此越过停机造成的空档继续向前翻页。
+        """
+        if field not in FIELDS:
+            raise ValueError(f"unknown field '{field}'")
+        start_ms = float(start_ms)
+        end_ms = float(end_ms)
+        bucket_ms = max(int(bucket_ms), 1)
+        if end_ms <= start_ms:
+            end_ms = start_ms + bucket_ms
+        span = end_ms - start_ms
+        if span / bucket_ms > limit:
+            bucket_ms = int(math.ceil(span / limit))
+        tier = self.tiers[0]
+        for candidate in self.tiers:
+            if candidate.period_ms <= bucket_ms:
+                tier = candidate
+        # 桶边界按桶宽对齐，与聚合级一致
+        start_ms -= start_ms % bucket_ms
+
+        first = tier.first_time()
+        before = tier.last_before(start_ms)
+        out = {"field": field, "bucket": bucket_ms, "tier": tier.name, "start": int(start_ms),
+               "first": None if math.isinf(first) else int(first),
+               "before": None if before is None else int(before),
+               "t": [], "open": [], "high": [], "low": [], "close": [], "mean": []}
+        cur_t = None
+        cur_n = 0
+        cur_sum = 0.0
+        for t, n, o, h, l, c, mean in tier.rows(field, start_ms, end_ms):
+            b = t - t % bucket_ms
+            if b != cur_t:
+                if cur_t is not None:
+                    out["mean"].append(cur_sum / cur_n)
+                cur_t = b
+                cur_n = 0
+                cur_sum = 0.0
+                out["t"].append(int(b))
+                out["open"].append(o)
+                out["high"].append(h)
+                out["low"].append(l)
+                out["close"].append(c)
+            else:
+                if h > out["high"][-1]: out["high"][-1] = h
+                if l < out["low"][-1]: out["low"][-1] = l
+                out["close"][-1] = c
+            cur_n += n
+            cur_sum += mean * n
+        if cur_t is not None:
+            out["mean"].append(cur_sum / cur_n)
+        for key in AGGREGATES:
+            out[key] = [round(v, 4) for v in out[key]]
+        return out
+
+    def flush(self):
+        for tier in self.tiers:
+            tier.flush()
+
+    def close(self):
+        self.flush()
+        for tier in self.tiers:
+            tier.close()
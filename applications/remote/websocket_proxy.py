@@ -1,61 +1,235 @@
 import asyncio
+import collections
 import json
+import os
+import struct
+import time
 import websockets
+from timeseries import TimeSeriesStore
+from clock_sync import BoardClock, host_now_ms
 
 # 板子的TCP服务器地址和端口
 TCP_SERVER_IP = "192.168.5.44"
 TCP_SERVER_PORT = 5000
 
+# 板端推送周期 (ms)，为控制周期(100 ms)的整数倍
+SUBSCRIBE_PERIOD_MS = 100
+
+# 使用二进制状态帧 (proto bin)，浏览器侧仍然收到 JSON
+USE_BINARY_PROTOCOL = True
+USE_DELTA_FRAMES = True
+
 # WebSocket服务器的地址和端口
 WS_SERVER_IP = "0.0.0.0"
 WS_SERVER_PORT = 8765
 
+# 历史数据目录（只追加的列式文件，见 timeseries.py）与刷盘周期
+HISTORY_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "history")
+HISTORY_FLUSH_S = 5
+
+# 每个浏览器的待发送状态帧上限，慢客户端超出时丢弃最旧的一帧；设为 1 即只保留最新状态
+CLIENT_QUEUE_LIMIT = 32
+# 客户端统计（队列延迟、丢帧）的打印周期 (s)
+CLIENT_STATS_S = 30
+
 # 全局共享资源
-clients = set()
+clients = {}        # websocket -> ClientChannel
 tcp_writer = None
+store = None
+clock = BoardClock()    # 板端 tick → 主机时间
+last_ts = 0             # 上一个样本的主机时间戳，保证单调
+
+# --- 二进制状态帧，布局与 applications/remote/status_frame.h 一致 ---
+FRAME_MAGIC = b'\xA5\x5A'
+FRAME_VERSION = 1
+FRAME_FULL = 0x01
+FRAME_DELTA = 0x02
+FRAME_HEADER = struct.Struct('<2sBBH')
+STATUS_RECORD = struct.Struct('<IIhhhhhHHBB8f4h4H')
+STATUS_WORDS = STATUS_RECORD.size // 2
+DELTA_MASK_LEN = (STATUS_WORDS + 7) // 8
+FRAME_MAX_PAYLOAD = STATUS_RECORD.size + DELTA_MASK_LEN  # 最长的帧是全部字都变化的增量帧
+STATES = {0: 'HEATING', 1: 'WARMING', 2: 'COOLING'}
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def record_to_status(raw):
+    """把 status_record_t 还原为与 get_status JSON 相同的字段"""
+    (cycle, ts, ptc, box, target, ptc_target, env, humi, duty, state, flags,
+     heat_kp, heat_ki, heat_kd, box_kp, box_ki, box_kd, cool_kp, cool_ki,
+     warming_bias, heating_bias, warming_threshold, hysteresis_band,
+     dt_10us, jitter_us, dt_max_10us, overruns) = STATUS_RECORD.unpack(raw)
+    r4 = lambda x: round(x, 4)
+    return {
+        "cycle": cycle,
+        "timestamp_ms": ts,
+        "current_ptc_temperature": ptc / 100.0,
+        "current_temperature": box / 100.0,
+        "target_temperature": target / 100.0,
+        "ptc_target_temperature": ptc_target / 100.0,
+        "current_humidity": humi / 100.0,
+        "env_temperature": env / 100.0,
+        "ptc_state": "ON" if flags & 0x01 else "OFF",
+        "control_mode": "MPC" if flags & 0x02 else "PID",
+        "ptc_sensor": "FAULT" if flags & 0x04 else "OK",
+        "control_state": STATES.get(state, "ERROR!!!"),
+        "current_pwm": duty / 10000.0,
+        "heat_kp": r4(heat_kp), "heat_ki": r4(heat_ki), "heat_kd": r4(heat_kd),
+        "box_kp": r4(box_kp), "box_ki": r4(box_ki), "box_kd": r4(box_kd),
+        "cool_kp": r4(cool_kp), "cool_ki": r4(cool_ki),
+        "warming_bias": warming_bias / 100.0,
+        "heating_bias": heating_bias / 100.0,
+        "warming_threshold": warming_threshold / 100.0,
+        "hysteresis_band": hysteresis_band / 100.0,
+        "ctrl_dt_ms": dt_10us / 100.0,
+        "ctrl_jitter_ms": jitter_us / 1000.0,
+        "ctrl_dt_max_ms": dt_max_10us / 100.0,
+        "ctrl_overruns": overruns,
+    }
+
+
+class BoardStreamDecoder:
+    """
+    拆分板端字节流：以 0xA5 0x5A 开头的是二进制状态帧，其余按 CRLF 分行。
+    返回 ('status', dict, raw) 或 ('text', str, None)，raw 为板端原样的 JSON 文本（二进制帧为 None）。
+    """
+    def __init__(self):
+        self.buffer = bytearray()
+        self.last_record = None     # 差分基准，收到完整帧之前丢弃差分帧
+        self.skip_bytes = 0         # history 命令返回的二进制记录，直接跳过
+
+    def feed(self, data):
+        self.buffer.extend(data)
+        messages = []
+        while True:
+            if self.skip_bytes:
+                n = min(self.skip_bytes, len(self.buffer))
+                del self.buffer[:n]
+                self.skip_bytes -= n
+                if self.skip_bytes:
+                    break
+            if self.buffer[:2] == FRAME_MAGIC:
+                message, complete = self._take_frame()
+            else:
+                message, complete = self._take_line()
+            if not complete:
+                break
+            if message is not None:
+                messages.append(message)
+        return messages
+
+    def _take_line(self):
+        end = self.buffer.find(b'\r\n')
+        magic = self.buffer.find(FRAME_MAGIC)
+        if magic > 0 and (end < 0 or magic < end):
+            # 板端文本均为ASCII，魔数之前的残余字节来自损坏的帧，丢弃后重新同步
+            del self.buffer[:magic]
+            return None, True
+        if end < 0:
+            return None, False
+        line = self.buffer[:end].decode('utf-8', errors='ignore')
+        del self.buffer[:end + 2]
+        if line.startswith('HISTORY '):
+            parts = line.split()
+            if len(parts) == 4:
+                self.skip_bytes = int(parts[2]) * int(parts[3])
+        json_start = line.find('{')
+        if json_start != -1:
+            try:
+                raw = line[json_start:]
+                return ('status', json.loads(raw), raw), True
+            except json.JSONDecodeError as e:
+                # 忽略无法解析的行，因为它们可能是命令的响应而不是状态JSON
+                print(f"Ignoring non-JSON message or parse error: {e}, Message: '{line}'")
+                return None, True
+        return ('text', line, None), True
+
+    def _take_frame(self):
+        if len(self.buffer) < FRAME_HEADER.size:
+            return None, False
+        _, version, frame_type, payload_len = FRAME_HEADER.unpack_from(self.buffer)
+        # 长度字段在 CRC 校验之前就决定要等多少字节，先按协议上限检查，避免为损坏的帧头无限等待
+        if version != FRAME_VERSION or payload_len > FRAME_MAX_PAYLOAD:
+            return self._drop_corrupted()
+        total = FRAME_HEADER.size + payload_len + 2
+        if len(self.buffer) < total:
+            return None, False
+        frame = bytes(self.buffer[:total])
+        crc = int.from_bytes(frame[-2:], 'little')
+        if crc16_ccitt(frame[:-2]) != crc:
+            return self._drop_corrupted()
+        del self.buffer[:total]
+        payload = frame[FRAME_HEADER.size:-2]
+
+        if frame_type == FRAME_FULL and len(payload) == STATUS_RECORD.size:
+            record = bytearray(payload)
+        elif frame_type == FRAME_DELTA and self.last_record is not None:
+            mask, data = payload[:DELTA_MASK_LEN], payload[DELTA_MASK_LEN:]
+            record = bytearray(self.last_record)
+            pos = 0
+            for i in range(STATUS_WORDS):
+                if mask[i // 8] & (1 << (i % 8)):
+                    record[2 * i:2 * i + 2] = data[pos:pos + 2]
+                    pos += 2
+        else:
+            return None, True  # 等待下一个完整帧
+        self.last_record = record
+        return ('status', record_to_status(bytes(record)), None), True
+
+    def _drop_corrupted(self):
+        # 帧头损坏：丢掉魔数的第一个字节重新寻找同步
+        print("Dropping corrupted status frame.")
+        del self.buffer[:1]
+        self.last_record = None
+        return None, True
+
 
 async def tcp_communication_manager():
     """
     维持一个到TCP服务器的持久连接
     """
     global tcp_writer
-    buffer = ""
     while True:
+        probe_task = None
         try:
             reader, writer = await asyncio.open_connection(TCP_SERVER_IP, TCP_SERVER_PORT)
             tcp_writer = writer
+            decoder = BoardStreamDecoder()
             print(f"Successfully connected to TCP server at {TCP_SERVER_IP}:{TCP_SERVER_PORT}")
 
-            # 启动一个独立的任务来定期请求状态
-            asyncio.create_task(request_status_periodically())
+            # 订阅板端推送，不再逐次轮询 get_status
+            await subscribe_status()
+            clock.reset()
+            probe_task = asyncio.create_task(probe_clock(writer))
 
             while True:
                 data = await reader.read(1024)
+                t_read = host_now_ms()
                 if not data:
                     print("TCP server closed the connection. Reconnecting...")
                     tcp_writer = None
                     break
-                
-                buffer += data.decode('utf-8', errors='ignore')
 
                 # 处理缓冲区中所有完整的消息
-                while '\r\n' in buffer:
-                    message, buffer = buffer.split('\r\n', 1)
-                    try:
-                        json_start = message.find('{')
-                        if json_start != -1:
-                            json_message = message[json_start:]
-                            status = json.loads(json_message)
-                            
-                            if status and clients:
-                                broadcast_message = json.dumps(status)
-                                await asyncio.gather(
-                                    *[client.send(broadcast_message) for client in clients if client.open]
-                                )
-                    except json.JSONDecodeError as e:
-                        # 忽略无法解析的行，因为它们可能是命令的响应而不是状态JSON
-                        print(f"Ignoring non-JSON message or parse error: {e}, Message: '{message}'")
-                        pass
+                for kind, message, raw in decoder.feed(data):
+                    if kind == 'text' and message.startswith('TIME '):
+                        clock.on_reply(int(message.split()[1]), t_read)
+                        continue
+                    if kind != 'status' or not message:
+                        continue
+                    ts = sample_time(message)
+                    message["ts"] = ts
+                    store.append(ts, message)
+                    if clients:
+                        broadcast(status_payload(message, raw, ts))
 
         except (ConnectionRefusedError, OSError) as e:
             print(f"Failed to connect to TCP server: {e}. Retrying in 5 seconds...")
@@ -65,27 +239,186 @@ async def tcp_communication_manager():
             print(f"An unexpected error in TCP manager: {e}. Retrying in 5 seconds...")
             tcp_writer = None
             await asyncio.sleep(5)
+        finally:
+            if probe_task is not None:
+                probe_task.cancel()
 
-async def request_status_periodically():
-    """定期通过共享的writer发送get_status命令。"""
+
+def sample_time(message):
+    """
+    样本的主机时间戳 (ms)：由板端快照时刻 timestamp_ms 经时钟映射得到，
+    与网络延迟、代理停顿无关；时钟尚未同步时退回代理接收时刻
+    """
+    global last_ts
+    board_ms = message.get("timestamp_ms")
+    host_ms = clock.to_host_ms(board_ms) if isinstance(board_ms, int) else None
+    ts = int(round(host_ms)) if host_ms is not None else int(time.time() * 1000)
+    # 拟合更新可能让映射回退几毫秒，时间列必须单调
+    ts = max(ts, last_ts + 1)
+    last_ts = ts
+    return ts
+
+
+async def probe_clock(writer):
+    """周期性发送 time 命令，回复在 TCP 读循环中交给 clock"""
+    try:
+        while not writer.is_closing():
+            writer.write(b"time\r\n")
+            clock.probe_sent()
+            await writer.drain()
+            await asyncio.sleep(clock.probe_interval())
+    except (ConnectionError, OSError):
+        pass
+
+async def subscribe_status():
+    """通过共享的writer协商帧格式并发送subscribe命令，此后板端按周期主动推送状态。"""
+    if tcp_writer and not tcp_writer.is_closing():
+        try:
+            commands = []
+            if USE_BINARY_PROTOCOL:
+                commands.append("proto bin delta" if USE_DELTA_FRAMES else "proto bin")
+            commands.append(f"subscribe {SUBSCRIBE_PERIOD_MS}")
+            # 板端按行拆分并按序回复，多条命令可以一次写出
+            tcp_writer.write("".join(f"{c}\r\n" for c in commands).encode('utf-8'))
+            await tcp_writer.drain()
+        except Exception as e:
+            print(f"Error sending subscribe: {e}")
+
+
+class ClientChannel:
+    """
+    一个浏览器连接的发送队列。TCP 读循环只入队、从不等待发送，
+    由每个连接自己的发送任务按序写出，慢客户端只会让自己丢帧。
+    命令回复（history 等）另排一队，不丢弃且优先发送。
+    """
+
+    def __init__(self, websocket):
+        self.websocket = websocket
+        self.status = collections.deque(maxlen=CLIENT_QUEUE_LIMIT)     # (入队时刻, 文本)
+        self.replies = collections.deque()
+        self.wakeup = asyncio.Event()
+        self.sent = 0
+        self.dropped = 0
+        self.lag_ms = 0.0           # 最近一帧从入队到写出的时间
+        self.max_lag_ms = 0.0       # 上次统计以来的最大值
+        self.task = asyncio.create_task(self._sender())
+
+    def push_status(self, payload):
+        if len(self.status) == self.status.maxlen:
+            self.dropped += 1
+        self.status.append((time.monotonic(), payload))
+        self.wakeup.set()
+
+    def push_reply(self, payload):
+        self.replies.append((time.monotonic(), payload))
+        self.wakeup.set()
+
+    async def _sender(self):
+        try:
+            while True:
+                await self.wakeup.wait()
+                self.wakeup.clear()
+                while self.replies or self.status:
+                    queued_at, payload = (self.replies or self.status).popleft()
+                    await self.websocket.send(payload)
+                    self.sent += 1
+                    self.lag_ms = (time.monotonic() - queued_at) * 1000.0
+                    self.max_lag_ms = max(self.max_lag_ms, self.lag_ms)
+        except websockets.exceptions.ConnectionClosed:
+            pass    # 由 handle_websocket_client 清理
+
+    def stats(self):
+        address = self.websocket.remote_address
+        return {
+            "client": f"{address[0]}:{address[1]}" if address else "?",
+            "queued": len(self.status) + len(self.replies),
+            "sent": self.sent,
+            "dropped": self.dropped,
+            "lag_ms": round(self.lag_ms, 1),
+            "max_lag_ms": round(self.max_lag_ms, 1),
+        }
+
+
+def status_payload(message, raw, ts):
+    """
+    生成发给浏览器的状态文本，每个样本只序列化一次。
+    板端发来的是 JSON 行时原样转发，只在开头插入 ts 字段
+    """
+    if raw is not None and raw.startswith('{') and raw != '{}':
+        return f'{{"ts": {ts}, ' + raw[1:]
+    return json.dumps(message)
+
+
+def broadcast(payload):
+    for channel in clients.values():
+        channel.push_status(payload)
+
+
+async def report_clients():
+    """定期打印板端时钟同步状态，以及各客户端的发送延迟与丢帧数"""
     while True:
-        if tcp_writer and not tcp_writer.is_closing():
-            try:
-                tcp_writer.write(b"get_status\r\n")
-                await tcp_writer.drain()
-            except Exception as e:
-                print(f"Error sending get_status: {e}")
-                # 连接可能已损坏，等待主循环处理重连
-                break 
-        await asyncio.sleep(0.1)
+        await asyncio.sleep(CLIENT_STATS_S)
+        st = clock.stats()
+        if st["locked"]:
+            print(f"Board clock: offset {st['offset_ms']} ms, drift {st['drift_ppm']} ppm, "
+                  f"min RTT {st['rtt_min_ms']} ms ({st['samples']} probes)")
+        for channel in list(clients.values()):
+            st = channel.stats()
+            print(f"Client {st['client']}: sent {st['sent']}, dropped {st['dropped']}, "
+                  f"queued {st['queued']}, lag {st['lag_ms']} ms (max {st['max_lag_ms']} ms)")
+            channel.max_lag_ms = 0.0
+
+
+def answer_query(message):
+    """
+    处理面板的 JSON 请求，返回回复字典；不是请求时返回 None（按板端命令转发）。
+    {"type": "history", "field": ..., "start": ms, "end": ms, "bucket": ms, "id": ...}
+    {"type": "clients", "id": ...}：各客户端的队列长度、丢帧数与发送延迟
+    {"type": "clock", "id": ...}：板端时钟的偏移、漂移与最小往返时间
+    """
+    try:
+        request = json.loads(message)
+    except json.JSONDecodeError:
+        return None
+    if not isinstance(request, dict):
+        return None
+    if request.get("type") == "clock":
+        reply = {"type": "clock", "id": request.get("id")}
+        reply.update(clock.stats())
+        return reply
+    if request.get("type") == "clients":
+        return {"type": "clients", "id": request.get("id"),
+                "clients": [channel.stats() for channel in clients.values()]}
+    if request.get("type") != "history":
+        return None
+    reply = {"type": "history", "id": request.get("id")}
+    try:
+        reply.update(store.query(request.get("field", "current_temperature"),
+                                 request["start"], request["end"], request.get("bucket", 60000)))
+    except (KeyError, TypeError, ValueError) as e:
+        reply["error"] = str(e)
+    return reply
+
+
+async def flush_history():
+    """定期把内存映射的历史文件刷到磁盘"""
+    while True:
+        await asyncio.sleep(HISTORY_FLUSH_S)
+        store.flush()
 
 
 async def handle_websocket_client(websocket):
     """处理单个WebSocket客户端连接。"""
-    clients.add(websocket)
+    channel = ClientChannel(websocket)
+    clients[websocket] = channel
     print(f"New client connected. Total clients: {len(clients)}")
     try:
         async for message in websocket:
+            if message.startswith('{'):
+                reply = answer_query(message)
+                if reply is not None:
+                    channel.push_reply(json.dumps(reply))
+                    continue
             print(f"Received command from client: {message}")
             if tcp_writer and not tcp_writer.is_closing():
                 try:
@@ -99,12 +432,18 @@ async def handle_websocket_client(websocket):
     except websockets.exceptions.ConnectionClosed:
         print("Client connection closed normally.")
     finally:
-        clients.remove(websocket)
-        print(f"Client disconnected. Total clients: {len(clients)}")
+        del clients[websocket]
+        channel.task.cancel()
+        st = channel.stats()
+        print(f"Client disconnected ({st['sent']} sent, {st['dropped']} dropped). Total clients: {len(clients)}")
 
 async def main():
     """主函数，启动WebSocket服务器和TCP通信管理器"""
+    global store
+    store = TimeSeriesStore(HISTORY_DIR)
     asyncio.create_task(tcp_communication_manager())
+    asyncio.create_task(flush_history())
+    asyncio.create_task(report_clients())
     
     server = await websockets.serve(handle_websocket_client, WS_SERVER_IP, WS_SERVER_PORT)
     print(f"WebSocket server started at ws://{WS_SERVER_IP}:{WS_SERVER_PORT}")
@@ -116,3 +455,6 @@ if __name__ == "__main__":
         asyncio.run(main())
     except KeyboardInterrupt:
         print("Server stopped.")
+    finally:
+        if store is not None:
+            store.close()
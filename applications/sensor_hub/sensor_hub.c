@@ -0,0 +1,262 @@
+#include <rtdevice.h>
+#include <ktime.h>
+#include "sensor_hub.h"
+#include "dht11.h"
+#ifdef PKG_USING_P3T1755
+#include "p3t1755.h"
+#endif
+
+/*******************************************************************************
+ * 参数定义
+ ******************************************************************************/
+#define SENSOR_HUB_STACK_SIZE   1024
+#define SENSOR_HUB_PRIORITY     11
+
+/* 数据源：一个物理传感器，可发布到一个或多个通道 */
+typedef struct {
+    const char *name;
+    rt_uint32_t period_ms;      // 采样周期，可通过 RT_SENSOR_CTRL_SET_ODR 修改
+    rt_tick_t next;             // 下一次采样的节拍
+    void (*poll)(void);
+} hub_source_t;
+
+/* 通道：对应一个传感器框架设备 */
+typedef struct {
+    struct rt_sensor_device sensor;
+    sensor_sample_t sample;
+    hub_source_t *source;
+} hub_channel_t;
+
+static void poll_env(void);
+static void poll_box(void);
+
+static hub_source_t hub_sources[] = {
+    { "env",   SENSOR_HUB_ENV_PERIOD_MS, 0, poll_env },
+    { "dht11", SENSOR_HUB_BOX_PERIOD_MS, 0, poll_box },
+};
+static hub_channel_t hub_channels[SENSOR_HUB_CHANNELS];
+static rt_thread_t hub_thread = RT_NULL;
+
+extern void rt_sensor_cb(rt_sensor_t sen);
+
+/*******************************************************************************
+ * 函数定义
+ ******************************************************************************/
+/**
+ * @return ktime 启动时间 (us)
+ */
+rt_uint64_t sensor_hub_now_us(void)
+{
+    struct timespec ts;
+    rt_ktime_boottime_get_ns(&ts);
+    return (rt_uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief  更新通道样本并通知订阅者
+ */
+static void hub_publish(sensor_hub_channel_t channel, float value, rt_uint64_t timestamp_us)
+{
+    hub_channel_t *ch = &hub_channels[channel];
+
+    rt_enter_critical();
+    ch->sample.value = value;
+    ch->sample.timestamp_us = timestamp_us;
+    ch->sample.seq++;
+    rt_exit_critical();
+
+    rt_sensor_cb(&ch->sensor);
+}
+
+/**
+ * @brief  取得通道最新样本，不等待
+ * @return 通道尚无数据时返回 -RT_EEMPTY
+ */
+rt_err_t sensor_hub_get(sensor_hub_channel_t channel, sensor_sample_t *sample)
+{
+    if (channel >= SENSOR_HUB_CHANNELS) return -RT_EINVAL;
+
+    rt_enter_critical();
+    *sample = hub_channels[channel].sample;
+    rt_exit_critical();
+    return sample->seq ? RT_EOK : -RT_EEMPTY;
+}
+
+static void poll_env(void)
+{
+#ifdef PKG_USING_P3T1755
+    float temp;
+    rt_uint64_t now = sensor_hub_now_us();
+    if (p3t1755_read_temp(&temp) == RT_EOK)
+        hub_publish(SENSOR_HUB_ENV_TEMP, temp, now);
+#endif
+}
+
+/**
+ * @note   DHT11 由自己的线程每秒读取一次，这里只发布新结果；
+ *         时间戳按结果的采样节拍回推，精度为 1 个节拍
+ */
+static void poll_box(void)
+{
+    static rt_uint32_t last_reads = 0;
+    dht11_reading_t dht;
+
+    if (dht11_read(&dht) != RT_EOK || dht.reads == last_reads) return;
+    last_reads = dht.reads;
+
+    rt_uint64_t sampled = sensor_hub_now_us() - (rt_uint64_t)dht11_age_ms(&dht) * 1000U;
+    hub_publish(SENSOR_HUB_BOX_TEMP, dht.temperature, sampled);
+    hub_publish(SENSOR_HUB_BOX_HUMI, dht.humidity, sampled);
+}
+
+static void hub_entry(void *parameter)
+{
+    rt_tick_t now = rt_tick_get();
+    for (rt_size_t i = 0; i < sizeof(hub_sources) / sizeof(hub_sources[0]); i++)
+        hub_sources[i].next = now;
+
+    while (1)
+    {
+        // 运行所有到期的数据源，并找出最近的下一次到期时刻
+        now = rt_tick_get();
+        rt_tick_t wait = RT_TICK_MAX;
+        for (rt_size_t i = 0; i < sizeof(hub_sources) / sizeof(hub_sources[0]); i++)
+        {
+            hub_source_t *src = &hub_sources[i];
+            if ((rt_int32_t)(now - src->next) >= 0)
+            {
+                src->poll();
+                src->next += rt_tick_from_millisecond(src->period_ms);
+                // 落后一个周期以上时不补采，从现在重新计时
+                if ((rt_int32_t)(now - src->next) >= 0)
+                    src->next = now + rt_tick_from_millisecond(src->period_ms);
+            }
+            rt_tick_t remain = src->next - now;
+            if (remain < wait) wait = remain;
+        }
+        rt_thread_delay(wait);
+    }
+}
+
+static rt_ssize_t hub_fetch_data(struct rt_sensor_device *sensor, void *buf, rt_size_t len)
+{
+    struct rt_sensor_data *data = (struct rt_sensor_data *)buf;
+    sensor_sample_t sample;
+
+    if (sensor_hub_get((sensor_hub_channel_t)(rt_ubase_t)sensor->parent.user_data, &sample) != RT_EOK)
+        return 0;
+
+    // 框架的时间戳为 32 位毫秒，需要完整精度时用 sensor_hub_get()
+    data->timestamp = (rt_uint32_t)(sample.timestamp_us / 1000U);
+    data->type = sensor->info.type;
+    if (sensor->info.type == RT_SENSOR_CLASS_HUMI)
+        data->data.humi = (rt_int32_t)(sample.value * 10.0f);
+    else
+        data->data.temp = (rt_int32_t)(sample.value * 10.0f);
+    return 1;
+}
+
+static rt_err_t hub_control(struct rt_sensor_device *sensor, int cmd, void *args)
+{
+    hub_source_t *src = hub_channels[(rt_ubase_t)sensor->parent.user_data].source;
+
+    switch (cmd)
+    {
+    case RT_SENSOR_CTRL_SET_MODE:
+        // 只支持轮询与新样本通知，不使用中断引脚
+        return ((rt_ubase_t)args == RT_SENSOR_MODE_FIFO) ? -RT_EINVAL : RT_EOK;
+    case RT_SENSOR_CTRL_SET_POWER:
+        return RT_EOK;
+    case RT_SENSOR_CTRL_SET_ODR:
+    {
+        // 同一数据源的各通道共用采样周期
+        rt_uint32_t hz = (rt_ubase_t)args & 0xFFFF;
+        if (hz == 0 || hz > 1000) return -RT_EINVAL;
+        src->period_ms = 1000 / hz;
+        return RT_EOK;
+    }
+    default:
+        return -RT_ENOSYS;
+    }
+}
+
+static const struct rt_sensor_ops hub_ops = {
+    hub_fetch_data,
+    hub_control
+};
+
+static rt_err_t hub_register(sensor_hub_channel_t channel, const char *name, hub_source_t *source,
+                             rt_uint8_t type, rt_uint8_t vendor, const char *model,
+                             rt_uint8_t unit, rt_uint8_t intf, rt_int32_t range_min, rt_int32_t range_max)
+{
+    hub_channel_t *ch = &hub_channels[channel];
+
+    ch->source = source;
+    ch->sensor.info.type = type;
+    ch->sensor.info.vendor = vendor;
+    ch->sensor.info.model = model;
+    ch->sensor.info.unit = unit;
+    ch->sensor.info.intf_type = intf;
+    ch->sensor.info.range_min = range_min;
+    ch->sensor.info.range_max = range_max;
+    ch->sensor.info.period_min = source->period_ms;
+    ch->sensor.config.irq_pin.pin = RT_PIN_NONE;
+    ch->sensor.ops = &hub_ops;
+
+    return rt_hw_sensor_register(&ch->sensor, name, RT_DEVICE_FLAG_RDONLY | RT_DEVICE_FLAG_INT_RX,
+                                 (void *)(rt_ubase_t)channel);
+}
+
+/**
+ * @brief  注册传感器设备并启动采样线程
+ * @note   需在 dht11_init() 与 p3t1755_init() 之后调用
+ */
+rt_err_t sensor_hub_init(void)
+{
+    rt_err_t result = RT_EOK;
+
+    if (hub_thread != RT_NULL) return RT_EOK;
+
+    result |= hub_register(SENSOR_HUB_ENV_TEMP, "env", &hub_sources[0], RT_SENSOR_CLASS_TEMP,
+                           RT_SENSOR_VENDOR_UNKNOWN, "p3t1755", RT_SENSOR_UNIT_DCELSIUS,
+                           RT_SENSOR_INTF_I2C, -400, 1250);
+    result |= hub_register(SENSOR_HUB_BOX_TEMP, "box", &hub_sources[1], RT_SENSOR_CLASS_TEMP,
+                           RT_SENSOR_VENDOR_ASAIR, "dht11", RT_SENSOR_UNIT_DCELSIUS,
+                           RT_SENSOR_INTF_ONEWIRE, 0, 500);
+    result |= hub_register(SENSOR_HUB_BOX_HUMI, "box", &hub_sources[1], RT_SENSOR_CLASS_HUMI,
+                           RT_SENSOR_VENDOR_ASAIR, "dht11", RT_SENSOR_UNIT_PERMILLAGE,
+                           RT_SENSOR_INTF_ONEWIRE, 200, 900);
+    if (result != RT_EOK)
+    {
+        rt_kprintf("[SensorHub] Register sensor device failed.\n");
+        return -RT_ERROR;
+    }
+
+    hub_thread = rt_thread_create("SensorHub", hub_entry, RT_NULL, SENSOR_HUB_STACK_SIZE, SENSOR_HUB_PRIORITY, 10);
+    if (hub_thread == RT_NULL) return -RT_ENOMEM;
+    rt_thread_startup(hub_thread);
+    return RT_EOK;
+}
+
+/**
+ * @brief  列出各通道的最新样本与样本年龄
+ */
+void sensor_hub(int argc, char **argv)
+{
+    static const char *names[SENSOR_HUB_CHANNELS] = { "temp_env", "temp_box", "humi_box" };
+    rt_uint64_t now = sensor_hub_now_us();
+    sensor_sample_t sample;
+
+    for (int i = 0; i < SENSOR_HUB_CHANNELS; i++)
+    {
+        if (sensor_hub_get((sensor_hub_channel_t)i, &sample) != RT_EOK)
+        {
+            rt_kprintf("%-9s no data\n", names[i]);
+            continue;
+        }
+        rt_kprintf("%-9s %7.2f  age %6u ms  seq %u  period %u ms\n", names[i], sample.value,
+                   (rt_uint32_t)((now - sample.timestamp_us) / 1000U), sample.seq,
+                   hub_channels[i].source->period_ms);
+    }
+}
+MSH_CMD_EXPORT(sensor_hub, List sensor hub samples with their age);
@@ -0,0 +1,35 @@
+#ifndef SENSOR_HUB_H
+#define SENSOR_HUB_H
+
+/*******************************************************************************
+ * 传感器中枢
+ *
+ * 独立线程按各传感器自己的节奏采样，每个样本附带 ktime 启动时间戳 (us)，
+ * 并以传感器框架 v1 设备发布：temp_env（P3T1755）、temp_box / humi_box（DHT11）。
+ * 订阅者以 RT_DEVICE_FLAG_INT_RX 打开设备并设置 rx_indicate，每有新样本回调一次；
+ * 控制线程直接用 sensor_hub_get() 取带时间戳的最新值。
+ * PTC 温度由 ADC DMA 连续采集，仍在PID线程中按控制周期读取，不经过本模块。
+ ******************************************************************************/
+#include <rtthread.h>
+
+#define SENSOR_HUB_ENV_PERIOD_MS    2000    // 环境温度采样周期（变化缓慢）
+#define SENSOR_HUB_BOX_PERIOD_MS    250     // 检查 DHT11 新结果的周期（传感器本身 1 Hz）
+
+typedef enum {
+    SENSOR_HUB_ENV_TEMP = 0,    // 环境温度 (°C)
+    SENSOR_HUB_BOX_TEMP,        // 箱内温度 (°C)
+    SENSOR_HUB_BOX_HUMI,        // 箱内湿度 (%)
+    SENSOR_HUB_CHANNELS
+} sensor_hub_channel_t;
+
+typedef struct {
+    float value;
+    rt_uint64_t timestamp_us;   // 采样时刻（ktime 启动时间）
+    rt_uint32_t seq;            // 已发布的样本数，0 表示尚无数据
+} sensor_sample_t;
+
+rt_err_t sensor_hub_init(void);
+rt_err_t sensor_hub_get(sensor_hub_channel_t channel, sensor_sample_t *sample);
+rt_uint64_t sensor_hub_now_us(void);
+
+#endif /* SENSOR_HUB_H */
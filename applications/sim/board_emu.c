@@ -0,0 +1,520 @@
+/*******************************************************************************
+ * 板卡仿真器（PC端）：在 TCP 端口上冒充温控箱，用于代理与面板的压力测试
+ *
+ * 协议部分直接编译固件源文件 remote/remote.c、remote/status_frame.c、
+ * telemetry/telemetry.c 与 control/tune.c，RT-Thread 接口由 rtt_host/ 下的
+ * POSIX 替身提供，因此 get_status / subscribe / proto / time / history / tune
+ * 的回复与实机逐字节一致。每个虚拟箱体是一个独立进程（固件的全局状态不共享），
+ * 第 i 个箱体监听 port + i：
+ *   - 默认：控制律 (control/) 驱动集总参数热模型，节拍与 thermal_sim 相同
+ *   - --replay：按时间回放 thermal_sim --csv 或 test/history.py 导出的曲线，循环播放
+ * --speed 只加快仿真时间，板端时钟 (timestamp_ms / time) 始终是真实毫秒，
+ * 代理的时钟同步与推送节奏不受影响。
+ *
+ * 编译（在 applications/sim 目录下）：
+ *   gcc -O2 -DCONTROL_SIM -I../control -I../telemetry -I../remote -Irtt_host -I.. -o board_emu \
+ *       board_emu.c thermal_plant.c rtt_host/rtt_host.c ../remote/remote.c ../remote/status_frame.c \
+ *       ../telemetry/telemetry.c ../control/control.c ../control/estimator.c ../control/mpc.c \
+ *       ../control/ident.c ../control/tune.c -lm -lpthread
+ *
+ * 示例：
+ *   ./board_emu                                     一个箱体，监听 5000
+ *   ./board_emu --boxes 200 --port 6000 --quiet     200 个箱体，端口 6000-6199
+ *   ./board_emu --replay trace.csv --speed 60       以 60 倍速回放仿真曲线
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <signal.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include "rtthread.h"
+#include "control.h"
+#include "telemetry.h"
+#include "tune.h"
+#include "thermal_plant.h"
+
+#define PLANT_STEP_MS       10              // 热模型积分步长 (ms)，与 thermal_sim 一致
+#define STATE_SWITCH_MS     20              // 状态切换时PWM关断时间 (ms)，与main()一致
+#define EMU_MAX_BURST       1000            // 一次唤醒最多补跑的控制周期数，落后更多时丢弃并计入 overruns
+#define EMU_MAX_BOXES       1000
+#define TRACE_LINE_MAX      512
+
+/* 回放曲线的一行，字段含义与状态快照相同 */
+typedef struct {
+    double time_s;
+    float target;
+    float box;
+    float ptc;
+    float ptc_target;
+    float env;
+    float humidity;
+    float duty;             // 0~1
+    uint8_t state;          // control_state_t
+} trace_row_t;
+
+typedef struct {
+    trace_row_t *rows;
+    int count;
+    double duration_s;      // 回放一圈的长度
+} trace_t;
+
+typedef struct {
+    int port;
+    int boxes;
+    double speed;
+    float t_env;
+    float target;           // <0 表示沿用固件默认目标温度
+    unsigned int seed;
+    int quiet;
+    const char *replay_path;
+} emu_options_t;
+
+/* 单个箱体的仿真状态（每个进程一个） */
+typedef struct {
+    thermal_plant_t plant;
+    long sim_ms;            // 仿真时间 (ms)
+    int relay_cool;         // STATE_PIN: 0-PTC 1-风扇
+    float pwm_out;
+    long blank_until_ms;
+    float dht_filtered;
+    float dht_reading;
+    const trace_t *trace;
+    int trace_index;
+    double trace_offset_s;  // 各箱体在回放曲线上错开的起点
+} emu_box_t;
+
+static volatile sig_atomic_t emu_stop = 0;
+
+/*******************************************************************************
+ * tune：与固件 main.c 相同，经共享的调参会话提交
+ ******************************************************************************/
+static pthread_mutex_t tune_lock = PTHREAD_MUTEX_INITIALIZER;
+static tune_session_t tune_session;
+
+int tune_apply(int argc, char **argv)
+{
+    if (argc < 2) return -RT_ERROR;
+
+    pthread_mutex_lock(&tune_lock);
+    int result = tune_session_apply(&tune_session, rt_thread_self(), argc, argv);
+    pthread_mutex_unlock(&tune_lock);
+    if (result == TUNE_OK) return RT_EOK;
+    return (result == TUNE_BUSY) ? -RT_EBUSY : -RT_ERROR;
+}
+
+extern void remote_start(int argc, char **argv);
+
+/*******************************************************************************
+ * 工具函数
+ ******************************************************************************/
+static unsigned int rng_state = 1;
+
+static float rng_uniform(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (rng_state & 0xFFFFFF) / 16777216.0f;
+}
+
+static float rng_gauss(void)
+{
+    float u1 = rng_uniform() + 1e-7f;
+    float u2 = rng_uniform();
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+static double mono_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void sleep_until_ms(double deadline_ms)
+{
+    double wait = deadline_ms - mono_ms();
+    if (wait <= 0.0) return;
+    struct timespec ts = { (time_t)(wait / 1000.0), (long)(fmod(wait, 1000.0) * 1e6) };
+    nanosleep(&ts, NULL);
+}
+
+static int parse_state(const char *str)
+{
+    if (strncmp(str, "HEATING", 7) == 0) return CONTROL_STATE_HEATING;
+    if (strncmp(str, "COOLING", 7) == 0) return CONTROL_STATE_COOLING;
+    if (strncmp(str, "WARMING", 7) == 0) return CONTROL_STATE_WARMING;
+    return atoi(str);
+}
+
+/* 在表头中查找第一个存在的列名，返回列号，都不存在时返回 -1 */
+static int trace_column(char **names, int count, const char *a, const char *b)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(names[i], a) == 0 || (b != NULL && strcmp(names[i], b) == 0)) return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief  读取回放曲线
+ * @note   按表头识别两种格式：thermal_sim --csv（time_s，duty 为 0~1，box 取估计值 box_est）
+ *         与 test/history.py（timestamp_ms，duty 为百分比）；缺少的湿度按 50% 处理
+ */
+static int load_trace(const char *path, trace_t *trace)
+{
+    FILE *f = fopen(path, "r");
+    char line[TRACE_LINE_MAX];
+    char header[TRACE_LINE_MAX];
+    char *names[64];
+    char *fields[64];
+    int ncols = 0;
+    int capacity = 0;
+
+    if (f == NULL || fgets(header, sizeof(header), f) == NULL)
+    {
+        if (f) fclose(f);
+        return -1;
+    }
+    header[strcspn(header, "\r\n")] = '\0';
+    for (char *save, *tok = strtok_r(header, ",", &save); tok != NULL && ncols < 64; tok = strtok_r(NULL, ",", &save))
+        names[ncols++] = tok;
+
+    int c_time = trace_column(names, ncols, "time_s", NULL);
+    double time_scale = 1.0;
+    float duty_scale = 1.0f;
+    if (c_time < 0)
+    {
+        c_time = trace_column(names, ncols, "timestamp_ms", NULL);
+        time_scale = 0.001;
+        duty_scale = 0.01f;
+    }
+    int c_target = trace_column(names, ncols, "target", "target_temp");
+    int c_box = trace_column(names, ncols, "box_est", "box_temp");
+    int c_ptc = trace_column(names, ncols, "ptc", "ptc_temp");
+    int c_ptc_target = trace_column(names, ncols, "ptc_target", "ptc_target_temp");
+    int c_env = trace_column(names, ncols, "env", "env_temp");
+    int c_humidity = trace_column(names, ncols, "humidity", NULL);
+    int c_duty = trace_column(names, ncols, "duty", NULL);
+    int c_state = trace_column(names, ncols, "state", NULL);
+    if (c_time < 0 || c_target < 0 || c_box < 0 || c_ptc < 0 || c_env < 0 || c_duty < 0 || c_state < 0)
+    {
+        fprintf(stderr, "%s: unrecognised trace header\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    trace->rows = NULL;
+    trace->count = 0;
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        int n = 0;
+        line[strcspn(line, "\r\n")] = '\0';
+        for (char *save, *tok = strtok_r(line, ",", &save); tok != NULL && n < 64; tok = strtok_r(NULL, ",", &save))
+            fields[n++] = tok;
+        if (n < ncols) continue;
+
+        if (trace->count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 4096;
+            trace_row_t *rows = realloc(trace->rows, capacity * sizeof(*rows));
+            if (rows == NULL) { fclose(f); return -1; }
+            trace->rows = rows;
+        }
+        trace_row_t *r = &trace->rows[trace->count];
+        r->time_s = atof(fields[c_time]) * time_scale;
+        r->target = (float)atof(fields[c_target]);
+        r->box = (float)atof(fields[c_box]);
+        r->ptc = (float)atof(fields[c_ptc]);
+        r->ptc_target = c_ptc_target >= 0 ? (float)atof(fields[c_ptc_target]) : r->target;
+        r->env = (float)atof(fields[c_env]);
+        r->humidity = c_humidity >= 0 ? (float)atof(fields[c_humidity]) : 50.0f;
+        r->duty = (float)atof(fields[c_duty]) * duty_scale;
+        r->state = (uint8_t)parse_state(fields[c_state]);
+        // 时间必须递增（history.py 导出的记录可能跨越重启）
+        if (trace->count > 0 && r->time_s <= trace->rows[trace->count - 1].time_s) continue;
+        trace->count++;
+    }
+    fclose(f);
+    if (trace->count < 2) return -1;
+
+    // 以第一行为零点，一圈的长度加上一个平均采样间隔，首尾衔接时不重复
+    double t0 = trace->rows[0].time_s;
+    for (int i = 0; i < trace->count; i++) trace->rows[i].time_s -= t0;
+    double last = trace->rows[trace->count - 1].time_s;
+    trace->duration_s = last + last / (trace->count - 1);
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [options]\n", prog);
+    printf("  --port <n>          TCP port of the first box (default 5000)\n");
+    printf("  --boxes <n>         Number of virtual boxes, box i listens on port + i (default 1, max %d)\n", EMU_MAX_BOXES);
+    printf("  --speed <x>         Simulated seconds per wall-clock second (default 1)\n");
+    printf("  --env <temp>        Ambient temperature in C (default 22)\n");
+    printf("  --target <temp>     Initial target temperature in C (default: firmware default)\n");
+    printf("  --seed <n>          Noise seed, box i uses seed + i (default 1)\n");
+    printf("  --replay <file>     Replay a thermal_sim --csv or history.py trace in a loop instead of the plant\n");
+    printf("  --quiet             Silence per-box log output\n");
+}
+
+/*******************************************************************************
+ * 箱体仿真
+ ******************************************************************************/
+/**
+ * @brief  热模型推进一个控制周期，其中的采样与控制节拍与 thermal_sim 相同
+ */
+static void box_plant_cycle(emu_box_t *b)
+{
+    for (int k = 0; k < CONTROL_PERIOD_MS / PLANT_STEP_MS; k++)
+    {
+        long now_ms = b->sim_ms;
+
+        /* DHT11：一阶滞后 + 1°C 量化 */
+        b->dht_filtered += (b->plant.t_box - b->dht_filtered) * (PLANT_STEP_MS / 1000.0f) / 6.0f;
+
+        /* 主线程：采样与状态机 */
+        if (now_ms % SAMPLE_PERIOD_MS == 0)
+        {
+            env_temperature = b->plant.t_env;
+            b->dht_reading = roundf(b->dht_filtered);
+            control_estimate_box(b->dht_reading, 0.0f);
+            current_humidity = 50.0f;
+
+            control_state_t previous_state = control_state;
+            control_state = control_select_state(previous_state, current_temperature);
+            if (control_state != previous_state)
+            {
+                b->pwm_out = 0.0f;
+                b->blank_until_ms = now_ms + STATE_SWITCH_MS;
+                control_on_state_change(control_state);
+                b->relay_cool = (control_state == CONTROL_STATE_COOLING);
+            }
+        }
+
+        /* PID线程 */
+        if (now_ms % CONTROL_PERIOD_MS == 0)
+        {
+            ptc_temperature = b->plant.t_ptc + rng_gauss() * 0.05f;
+            double start = mono_ms();
+            control_estimate(CONTROL_PERIOD_MS / 1000.0f, !b->relay_cool);
+            control_identify(CONTROL_PERIOD_MS / 1000.0f, !b->relay_cool, b->dht_reading);
+            control_step(CONTROL_PERIOD_MS / 1000.0f);
+            control_timing_compute((float)((mono_ms() - start) / 1000.0));
+            if (now_ms >= b->blank_until_ms) b->pwm_out = final_pwm_duty;
+        }
+
+        thermal_plant_step(&b->plant, b->relay_cool ? 0.0f : b->pwm_out, b->relay_cool ? b->pwm_out : 0.0f,
+                           PLANT_STEP_MS / 1000.0f);
+        b->sim_ms += PLANT_STEP_MS;
+    }
+}
+
+/**
+ * @brief  回放推进一个控制周期：取仿真时刻所在的那一行写入控制变量
+ */
+static void box_replay_cycle(emu_box_t *b)
+{
+    const trace_t *tr = b->trace;
+    double t = fmod(b->sim_ms / 1000.0 + b->trace_offset_s, tr->duration_s);
+    int i = b->trace_index;
+
+    if (t < tr->rows[i].time_s) i = 0;     // 回到开头
+    while (i + 1 < tr->count && tr->rows[i + 1].time_s <= t) i++;
+    b->trace_index = i;
+
+    const trace_row_t *r = &tr->rows[i];
+    target_temperature = r->target;
+    current_temperature = r->box;
+    ptc_temperature = r->ptc;
+    ptc_target_temp = r->ptc_target;
+    env_temperature = r->env;
+    current_humidity = r->humidity;
+    final_pwm_duty = r->duty;
+    control_state = (control_state_t)r->state;
+    b->relay_cool = (r->state == CONTROL_STATE_COOLING);
+    b->sim_ms += CONTROL_PERIOD_MS;
+}
+
+static void box_stop(int sig)
+{
+    emu_stop = 1;
+}
+
+/**
+ * @brief  运行一个箱体（子进程入口），直到收到 SIGTERM/SIGINT
+ */
+static int run_box(const emu_options_t *opt, const trace_t *trace, int index)
+{
+    char tag[24];
+    char port[8];
+    emu_box_t box;
+
+    snprintf(tag, sizeof(tag), "[box %d]", opt->port + index);
+    rtt_host_init(opt->boxes > 1 ? tag : RT_NULL);
+    signal(SIGTERM, box_stop);
+    signal(SIGINT, box_stop);
+
+    memset(&box, 0, sizeof(box));
+    box.blank_until_ms = -1;
+    rng_state = (opt->seed + index) ? opt->seed + index : 1;
+
+    control_init();
+    telemetry_init();
+    thermal_plant_params_t params;
+    thermal_plant_default(&params);
+    thermal_plant_init(&box.plant, &params, opt->t_env);
+    box.dht_filtered = opt->t_env;
+    box.dht_reading = opt->t_env;
+    env_temperature = opt->t_env;
+    current_temperature = opt->t_env;
+    ptc_temperature = opt->t_env;
+    control_estimate_init(ptc_temperature, current_temperature);
+    if (opt->target >= 0.0f)
+    {
+        char value[16];
+        char *argv[] = { "tune", "target", value };
+        snprintf(value, sizeof(value), "%.2f", opt->target);
+        tune_apply(3, argv);
+    }
+    if (trace != NULL)
+    {
+        box.trace = trace;
+        box.trace_offset_s = trace->duration_s * index / opt->boxes;   // 各箱体错开，曲线不完全重合
+    }
+
+    snprintf(port, sizeof(port), "%d", opt->port + index);
+    char *start_argv[] = { "remote_start", port };
+    remote_start(2, start_argv);
+
+    /* 按真实时间的 speed 倍推进控制周期，主机跟不上时补跑，落后太多则丢弃 */
+    double period_ms = CONTROL_PERIOD_MS / opt->speed;
+    double start_ms = mono_ms();
+    uint64_t done = 0;
+    while (!emu_stop)
+    {
+        uint64_t due = (uint64_t)((mono_ms() - start_ms) / period_ms) + 1;
+        uint32_t missed = 0;
+        if (due > done + EMU_MAX_BURST)
+        {
+            missed = (uint32_t)(due - done - EMU_MAX_BURST);
+            done = due - EMU_MAX_BURST;
+        }
+        for (; done < due && !emu_stop; done++)
+        {
+            control_timing_update(CONTROL_PERIOD_MS / 1000.0f, missed);
+            missed = 0;
+            if (box.trace) box_replay_cycle(&box);
+            else box_plant_cycle(&box);
+
+            control_snapshot_t snap;
+            control_snapshot_publish(rt_tick_get_millisecond(), !box.relay_cool);
+            control_snapshot_read(&snap);
+            telemetry_append(&snap);
+        }
+        sleep_until_ms(start_ms + done * period_ms);
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * 主函数：每个箱体一个子进程
+ ******************************************************************************/
+static void parent_stop(int sig)
+{
+    emu_stop = 1;
+}
+
+int main(int argc, char **argv)
+{
+    emu_options_t opt;
+    trace_t trace;
+    pid_t children[EMU_MAX_BOXES];
+
+    memset(&opt, 0, sizeof(opt));
+    opt.port = 5000;
+    opt.boxes = 1;
+    opt.speed = 1.0;
+    opt.t_env = 22.0f;
+    opt.target = -1.0f;
+    opt.seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        int has_val = (i + 1 < argc);
+        if (strcmp(arg, "--port") == 0 && has_val) {
+            opt.port = atoi(argv[++i]);
+        } else if (strcmp(arg, "--boxes") == 0 && has_val) {
+            opt.boxes = atoi(argv[++i]);
+        } else if (strcmp(arg, "--speed") == 0 && has_val) {
+            opt.speed = atof(argv[++i]);
+        } else if (strcmp(arg, "--env") == 0 && has_val) {
+            opt.t_env = (float)atof(argv[++i]);
+        } else if (strcmp(arg, "--target") == 0 && has_val) {
+            opt.target = (float)atof(argv[++i]);
+        } else if (strcmp(arg, "--seed") == 0 && has_val) {
+            opt.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--replay") == 0 && has_val) {
+            opt.replay_path = argv[++i];
+        } else if (strcmp(arg, "--quiet") == 0) {
+            opt.quiet = 1;
+        } else {
+            usage(argv[0]);
+            return strcmp(arg, "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (opt.boxes < 1 || opt.boxes > EMU_MAX_BOXES || opt.speed <= 0.0
+        || opt.port <= 0 || opt.port + opt.boxes - 1 > 65535)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if (opt.replay_path != NULL && load_trace(opt.replay_path, &trace) != 0)
+    {
+        fprintf(stderr, "Cannot load trace '%s'\n", opt.replay_path);
+        return 1;
+    }
+
+    printf("Emulating %d box%s on ports %d-%d at %.1fx speed (%s)\n", opt.boxes, opt.boxes > 1 ? "es" : "",
+           opt.port, opt.port + opt.boxes - 1, opt.speed, opt.replay_path ? opt.replay_path : "thermal model");
+    fflush(stdout);
+
+    signal(SIGINT, parent_stop);
+    signal(SIGTERM, parent_stop);
+    int started = 0;
+    for (; started < opt.boxes; started++)
+    {
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            perror("fork");
+            break;
+        }
+        if (pid == 0)
+        {
+            if (opt.quiet && freopen("/dev/null", "w", stdout) == NULL) return 1;
+            return run_box(&opt, opt.replay_path ? &trace : NULL, started);
+        }
+        children[started] = pid;
+    }
+
+    /* 任一箱体退出（例如端口被占用）或收到信号时结束全部箱体 */
+    int status;
+    while (!emu_stop && started == opt.boxes)
+    {
+        pid_t pid = wait(&status);
+        if (pid < 0 && errno == EINTR) continue;
+        fprintf(stderr, "Box process %d exited, stopping.\n", (int)pid);
+        break;
+    }
+    for (int i = 0; i < started; i++) kill(children[i], SIGTERM);
+    while (wait(&status) > 0 || errno == EINTR) {}
+    return 0;
+}
@@ -0,0 +1,8 @@
+#ifndef RTT_HOST_DRV_PIN_H
+#define RTT_HOST_DRV_PIN_H
+
+/* 主机上没有引脚，只保留 system_vars.h 用到的电平定义 */
+#define PIN_LOW                 0x00
+#define PIN_HIGH                0x01
+
+#endif /* RTT_HOST_DRV_PIN_H */
@@ -0,0 +1,22 @@
+#ifndef RTT_HOST_RTDEVICE_H
+#define RTT_HOST_RTDEVICE_H
+
+/*******************************************************************************
+ * rt_ringbuffer 的主机实现，行为与 RT-Thread 组件一致（put_force 覆盖最旧数据）
+ ******************************************************************************/
+#include "rtthread.h"
+
+struct rt_ringbuffer
+{
+    rt_uint8_t *buffer_ptr;
+    rt_uint32_t read_index;
+    rt_uint32_t write_index;
+    rt_uint32_t data_len;       // 替代 RT-Thread 的镜像位，便于区分空与满
+    rt_uint32_t buffer_size;
+};
+
+void rt_ringbuffer_init(struct rt_ringbuffer *rb, rt_uint8_t *pool, rt_int32_t size);
+rt_size_t rt_ringbuffer_put_force(struct rt_ringbuffer *rb, const rt_uint8_t *ptr, rt_uint32_t length);
+rt_size_t rt_ringbuffer_data_len(struct rt_ringbuffer *rb);
+
+#endif /* RTT_HOST_RTDEVICE_H */
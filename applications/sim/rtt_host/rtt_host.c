@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include "rtdevice.h"
+
+/*******************************************************************************
+ * 参数定义
+ ******************************************************************************/
+struct rt_thread
+{
+    pthread_t tid;
+    void (*entry)(void *parameter);
+    void *parameter;
+    char name[16];
+};
+
+static struct rt_thread main_thread = { .name = "main" };
+static __thread rt_thread_t current_thread = RT_NULL;
+static pthread_mutex_t critical_lock;
+static struct timespec boot_time;
+static const char *log_tag = RT_NULL;
+
+/*******************************************************************************
+ * 函数定义
+ ******************************************************************************/
+void rtt_host_init(const char *tag)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&critical_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    clock_gettime(CLOCK_MONOTONIC, &boot_time);
+    log_tag = tag;
+    main_thread.tid = pthread_self();
+    current_thread = &main_thread;
+    signal(SIGPIPE, SIG_IGN);
+}
+
+void rt_kprintf(const char *fmt, ...)
+{
+    char buf[256];
+    va_list args;
+    int len = 0;
+
+    if (log_tag != RT_NULL) len = snprintf(buf, sizeof(buf), "%s ", log_tag);
+    va_start(args, fmt);
+    vsnprintf(buf + len, sizeof(buf) - len, fmt, args);
+    va_end(args);
+    fputs(buf, stdout);
+    fflush(stdout);
+}
+
+rt_tick_t rt_tick_get(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (rt_tick_t)((now.tv_sec - boot_time.tv_sec) * 1000 + (now.tv_nsec - boot_time.tv_nsec) / 1000000);
+}
+
+rt_uint32_t rt_tick_get_millisecond(void)
+{
+    return rt_tick_get();
+}
+
+rt_tick_t rt_tick_from_millisecond(rt_int32_t ms)
+{
+    return (rt_tick_t)ms;
+}
+
+static void *thread_trampoline(void *arg)
+{
+    rt_thread_t thread = arg;
+    current_thread = thread;
+    thread->entry(thread->parameter);
+    return NULL;
+}
+
+/**
+ * @brief  创建线程；栈大小与优先级在主机上无意义，仅为保持接口一致
+ */
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *parameter), void *parameter,
+                             rt_uint32_t stack_size, rt_uint8_t priority, rt_uint32_t tick)
+{
+    rt_thread_t thread = calloc(1, sizeof(*thread));
+    if (thread == RT_NULL) return RT_NULL;
+    thread->entry = entry;
+    thread->parameter = parameter;
+    snprintf(thread->name, sizeof(thread->name), "%s", name);
+    return thread;
+}
+
+rt_err_t rt_thread_startup(rt_thread_t thread)
+{
+    if (pthread_create(&thread->tid, NULL, thread_trampoline, thread) != 0) return -RT_ERROR;
+    pthread_detach(thread->tid);
+    return RT_EOK;
+}
+
+rt_thread_t rt_thread_self(void)
+{
+    return current_thread;
+}
+
+rt_err_t rt_thread_mdelay(rt_int32_t ms)
+{
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+    return RT_EOK;
+}
+
+void rt_enter_critical(void)
+{
+    pthread_mutex_lock(&critical_lock);
+}
+
+void rt_exit_critical(void)
+{
+    pthread_mutex_unlock(&critical_lock);
+}
+
+/*******************************************************************************
+ * 环形缓冲
+ ******************************************************************************/
+void rt_ringbuffer_init(struct rt_ringbuffer *rb, rt_uint8_t *pool, rt_int32_t size)
+{
+    rb->buffer_ptr = pool;
+    rb->buffer_size = (rt_uint32_t)size;
+    rb->read_index = 0;
+    rb->write_index = 0;
+    rb->data_len = 0;
+}
+
+/**
+ * @brief  写入数据，空间不足时丢弃最旧的数据
+ */
+rt_size_t rt_ringbuffer_put_force(struct rt_ringbuffer *rb, const rt_uint8_t *ptr, rt_uint32_t length)
+{
+    if (length > rb->buffer_size)
+    {
+        ptr += length - rb->buffer_size;
+        length = rb->buffer_size;
+    }
+    for (rt_uint32_t i = 0; i < length; i++)
+    {
+        rb->buffer_ptr[rb->write_index] = ptr[i];
+        rb->write_index = (rb->write_index + 1) % rb->buffer_size;
+    }
+    rb->data_len += length;
+    if (rb->data_len > rb->buffer_size)
+    {
+        rb->data_len = rb->buffer_size;
+        rb->read_index = rb->write_index;
+    }
+    return length;
+}
+
+rt_size_t rt_ringbuffer_data_len(struct rt_ringbuffer *rb)
+{
+    return rb->data_len;
+}
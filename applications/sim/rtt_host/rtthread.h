@@ -0,0 +1,73 @@
+#ifndef RTT_HOST_RTTHREAD_H
+#define RTT_HOST_RTTHREAD_H
+
+/*******************************************************************************
+ * RT-Thread 接口的 POSIX 替身（PC端板卡仿真器用）
+ *
+ * 只覆盖 remote/、telemetry/ 用到的部分，使这些源文件不加修改地在主机上编译：
+ *   - 线程以 pthread 实现，rt_enter_critical 为一把全局递归锁
+ *   - rt_tick 为进程启动以来的毫秒数（RT_TICK_PER_SECOND = 1000）
+ *   - lwIP 的 BSD socket 直接映射到主机 socket
+ ******************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+typedef int8_t          rt_int8_t;
+typedef int16_t         rt_int16_t;
+typedef int32_t         rt_int32_t;
+typedef uint8_t         rt_uint8_t;
+typedef uint16_t        rt_uint16_t;
+typedef uint32_t        rt_uint32_t;
+typedef long            rt_base_t;
+typedef unsigned long   rt_ubase_t;
+typedef rt_base_t       rt_err_t;
+typedef rt_base_t       rt_bool_t;
+typedef size_t          rt_size_t;
+typedef rt_uint32_t     rt_tick_t;
+
+#define RT_TRUE                 1
+#define RT_FALSE                0
+#define RT_NULL                 NULL
+
+/* 错误码，与 RT-Thread 一致 */
+#define RT_EOK                  0
+#define RT_ERROR                1
+#define RT_ETIMEOUT             2
+#define RT_EBUSY                7
+
+#define RT_TICK_PER_SECOND      1000
+#define RT_ALIGN_SIZE           8
+#define rt_align(n)             __attribute__((aligned(n)))
+#define RT_ASSERT(expr)         assert(expr)
+
+#define rt_memset               memset
+#define rt_memcpy               memcpy
+
+#define MSH_CMD_EXPORT(command, desc)
+#define closesocket             close
+
+typedef struct rt_thread *rt_thread_t;
+
+void rt_kprintf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+rt_tick_t rt_tick_get(void);
+rt_uint32_t rt_tick_get_millisecond(void);
+rt_tick_t rt_tick_from_millisecond(rt_int32_t ms);
+
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *parameter), void *parameter,
+                             rt_uint32_t stack_size, rt_uint8_t priority, rt_uint32_t tick);
+rt_err_t rt_thread_startup(rt_thread_t thread);
+rt_thread_t rt_thread_self(void);
+rt_err_t rt_thread_mdelay(rt_int32_t ms);
+
+void rt_enter_critical(void);
+void rt_exit_critical(void);
+
+/* 主机侧初始化：日志前缀（NULL 为无前缀）、tick 零点，并忽略 SIGPIPE（lwIP 没有该信号） */
+void rtt_host_init(const char *log_tag);
+
+#endif /* RTT_HOST_RTTHREAD_H */
@@ -0,0 +1,51 @@
+#include <math.h>
+#include "thermal_plant.h"
+
+/**
+ * @brief  默认参数，按 warming_ff_table 的实测点粗略拟合
+ * @note   例：箱内 40°C 约需 PTC 52°C 维持，PTC 100°C 时箱内最高约 70°C；
+ *         冷态满功率时PTC可升至约 90°C，内环在 eval_ptc 期间不会一直饱和
+ */
+void thermal_plant_default(thermal_plant_params_t *params)
+{
+    params->c_ptc = 20.0f;
+    params->c_box = 800.0f;
+    params->g_ptc_box = 0.30f;
+    params->g_box_env = 0.20f;
+    params->g_fan = 6.0f;
+    params->fan_ptc_gain = 2.0f;
+    params->p_ptc_max = 20.0f;
+    params->t_curie = 125.0f;
+    params->t_curie_width = 4.0f;
+}
+
+void thermal_plant_init(thermal_plant_t *plant, const thermal_plant_params_t *params, float t_env)
+{
+    plant->p = *params;
+    plant->t_env = t_env;
+    plant->t_ptc = t_env;
+    plant->t_box = t_env;
+    plant->power = 0.0f;
+}
+
+/**
+ * @brief  前向欧拉积分一步，dt 需远小于 PTC 时间常数 (c_ptc / g_ptc_box ≈ 67 s)
+ */
+void thermal_plant_step(thermal_plant_t *plant, float heat_duty, float fan_duty, float dt)
+{
+    const thermal_plant_params_t *p = &plant->p;
+
+    if (heat_duty < 0.0f) heat_duty = 0.0f;
+    if (heat_duty > 1.0f) heat_duty = 1.0f;
+    if (fan_duty < 0.0f) fan_duty = 0.0f;
+    if (fan_duty > 1.0f) fan_duty = 1.0f;
+
+    float self_limit = 1.0f / (1.0f + expf((plant->t_ptc - p->t_curie) / p->t_curie_width));
+    plant->power = p->p_ptc_max * heat_duty * self_limit;
+
+    float q_ptc_box = p->g_ptc_box * (1.0f + p->fan_ptc_gain * fan_duty) * (plant->t_ptc - plant->t_box);
+    float q_box_env = (p->g_box_env + p->g_fan * fan_duty) * (plant->t_box - plant->t_env);
+
+    plant->t_ptc += (plant->power - q_ptc_box) / p->c_ptc * dt;
+    plant->t_box += (q_ptc_box - q_box_env) / p->c_box * dt;
+}
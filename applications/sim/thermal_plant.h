@@ -0,0 +1,36 @@
+#ifndef THERMAL_PLANT_H
+#define THERMAL_PLANT_H
+
+/*******************************************************************************
+ * 集总参数热模型（PC端仿真用）
+ *
+ *   PTC节点:  c_ptc * dTp/dt = P(duty, Tp) - g_ptc_box * (1 + fan_ptc_gain * fan) * (Tp - Tb)
+ *   箱内节点: c_box * dTb/dt = g_ptc_box * (...) * (Tp - Tb) - (g_box_env + g_fan * fan) * (Tb - Te)
+ *
+ * P(duty, Tp) 计入PTC自限温特性：接近居里温度时功率迅速下降。
+ ******************************************************************************/
+typedef struct {
+    float c_ptc;            // PTC+散热片热容 (J/K)
+    float c_box;            // 箱内空气及负载热容 (J/K)
+    float g_ptc_box;        // PTC→箱内 热导 (W/K)
+    float g_box_env;        // 箱体→环境 热导 (W/K)
+    float g_fan;            // 风扇满速时的附加换气热导 (W/K)
+    float fan_ptc_gain;     // 风扇满速时PTC→箱内热导的增益倍数
+    float p_ptc_max;        // PTC满占空比功率 (W)
+    float t_curie;          // PTC居里温度 (°C)
+    float t_curie_width;    // 自限温过渡宽度 (°C)
+} thermal_plant_params_t;
+
+typedef struct {
+    thermal_plant_params_t p;
+    float t_ptc;            // PTC温度 (°C)
+    float t_box;            // 箱内温度 (°C)
+    float t_env;            // 环境温度 (°C)
+    float power;            // 当前PTC功率 (W)
+} thermal_plant_t;
+
+void thermal_plant_default(thermal_plant_params_t *params);
+void thermal_plant_init(thermal_plant_t *plant, const thermal_plant_params_t *params, float t_env);
+void thermal_plant_step(thermal_plant_t *plant, float heat_duty, float fan_duty, float dt);
+
+#endif /* THERMAL_PLANT_H */
@@ -0,0 +1,521 @@
+/*******************************************************************************
+ * 温控箱闭环仿真器（PC端）
+ *
+ * 将固件中的控制律 (control/control.c) 与集总参数热模型 (thermal_plant.c)
+ * 链接在一起，用虚拟时钟按固件的线程节拍运行：
+ *   - 主线程：每 SAMPLE_PERIOD_MS 读取DHT11并执行状态机
+ *   - PID线程：每 CONTROL_PERIOD_MS 读取NTC，更新箱温估计并执行 control_step()
+ *   - 热模型：每 PLANT_STEP_MS 积分一次
+ * 24小时的升温/保温/降温曲线在PC上约1秒即可跑完。
+ *
+ * 编译（在 applications/sim 目录下）：
+ *   gcc -O2 -DCONTROL_SIM -I../control -o thermal_sim thermal_sim.c thermal_plant.c ../control/control.c ../control/estimator.c ../control/mpc.c ../control/ident.c -lm
+ *
+ * 示例：
+ *   ./thermal_sim                                   默认24h曲线：45°C → 60°C → 30°C
+ *   ./thermal_sim --profile 0:40,2h:55 --duration 4h --csv trace.csv
+ *   ./thermal_sim --gain heat 0.3 0.05 0.1 --eval-ptc 48 180000
+ *   ./thermal_sim --no-estimator                    外环直接使用DHT11读数，用于对比
+ *   ./thermal_sim --mpc                             以模型预测控制代替级联PID
+ *   ./thermal_sim --ident-apply 4h                  4小时后按在线辨识结果重新生成前馈表
+ *   ./thermal_sim --sched 48 heat 0.3 0.05 0.1 --sched 60 heat 0.4 0.06 0.1   按目标温度插值增益
+ *   ./thermal_sim --ff 0 ptc_ff.csv                 以CSV（每行 temp,value）中的标定点替换前馈表
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "control.h"
+#include "thermal_plant.h"
+
+#define PLANT_STEP_MS       10              // 热模型积分步长 (ms)
+#define STATE_SWITCH_MS     20              // 状态切换时PWM关断时间 (ms)，与main()一致
+#define MAX_PROFILE_POINTS  32
+#define MAX_SCHED_ARGS      (CONTROL_SCHED_ENTRIES * 3)
+
+typedef struct {
+    double time_s;      // 起始时间 (s)
+    float target;       // 目标温度 (°C)
+} profile_point_t;
+
+/* --sched 参数：某个温度点上一个控制器的增益 */
+typedef struct {
+    float target;
+    char which;         // 'b' / 'h' / 'c'
+    pid_gains_t gains;
+} sched_arg_t;
+
+typedef struct {
+    profile_point_t profile[MAX_PROFILE_POINTS];
+    int num_profile;
+    double duration_s;
+    float t_env;
+    float dht_resolution;   // DHT11分辨率 (°C)
+    float dht_tau;          // DHT11响应时间常数 (s)
+    float ntc_noise;        // NTC测量噪声标准差 (°C)
+    unsigned int seed;
+    const char *csv_path;
+    double csv_period_s;
+    float eval_target;      // eval_ptc 模式目标温度，<0 表示不启用
+    double eval_duration_s;
+    int quiet;
+    int no_estimator;       // 不使用状态估计，外环直接使用DHT11读数
+    int mpc;                // 使用 MPC 模式
+    double ident_apply_s;   // 按辨识结果重新生成前馈表的时刻 (s)，<0 表示不启用
+    sched_arg_t sched[MAX_SCHED_ARGS];
+    int num_sched;
+    ff_table_t ff[2];       // --ff 指定的前馈表：0-ptc, 1-warmt
+    int ff_loaded[2];
+} sim_options_t;
+
+typedef struct {
+    double iae;             // ∫|Tb - target| dt (°C·s)
+    double time_total;
+    float max_overshoot;    // 到达目标后的最大超调 (°C)
+    float max_ptc;
+    int state_switches;
+    double time_in_state[3];
+    double compute_total;   // PID线程计算耗时总和（主机CPU时间，s）
+    long compute_cycles;
+} sim_metrics_t;
+
+/*******************************************************************************
+ * 工具函数
+ ******************************************************************************/
+static unsigned int rng_state = 1;
+
+static float rng_uniform(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (rng_state & 0xFFFFFF) / 16777216.0f;
+}
+
+static float rng_gauss(void)
+{
+    float u1 = rng_uniform() + 1e-7f;
+    float u2 = rng_uniform();
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+/* 解析带单位的时间：90 / 90s / 30m / 8h */
+static int parse_time(const char *str, double *seconds)
+{
+    char *end;
+    double val = strtod(str, &end);
+    if (end == str) return -1;
+    switch (*end)
+    {
+        case '\0':
+        case 's': break;
+        case 'm': val *= 60.0; break;
+        case 'h': val *= 3600.0; break;
+        default: return -1;
+    }
+    *seconds = val;
+    return 0;
+}
+
+/* 解析目标曲线："0:45,8h:60,16h:30" */
+static int parse_profile(const char *str, sim_options_t *opt)
+{
+    char buf[512];
+    char *saveptr;
+    strncpy(buf, str, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    opt->num_profile = 0;
+    for (char *tok = strtok_r(buf, ",", &saveptr); tok != NULL; tok = strtok_r(NULL, ",", &saveptr))
+    {
+        char *colon = strchr(tok, ':');
+        if (colon == NULL || opt->num_profile >= MAX_PROFILE_POINTS) return -1;
+        *colon = '\0';
+        profile_point_t *pt = &opt->profile[opt->num_profile];
+        if (parse_time(tok, &pt->time_s) != 0) return -1;
+        pt->target = (float)atof(colon + 1);
+        if (opt->num_profile > 0 && pt->time_s <= opt->profile[opt->num_profile - 1].time_s) return -1;
+        opt->num_profile++;
+    }
+    return opt->num_profile > 0 ? 0 : -1;
+}
+
+static float profile_target(const sim_options_t *opt, double t)
+{
+    float target = opt->profile[0].target;
+    for (int i = 0; i < opt->num_profile && opt->profile[i].time_s <= t; i++)
+    {
+        target = opt->profile[i].target;
+    }
+    return target;
+}
+
+static int parse_gain(char **argv, int argc, int *i)
+{
+    if (*i + 4 >= argc) return -1;
+    const char *which = argv[*i + 1];
+    pid_ctx_t *pid;
+    if (strcmp(which, "box") == 0) pid = &pid_box;
+    else if (strcmp(which, "heat") == 0) pid = &pid_ptc;
+    else if (strcmp(which, "cool") == 0) pid = &pid_cool;
+    else return -1;
+    pid->kp = (float)atof(argv[*i + 2]);
+    pid->ki = (float)atof(argv[*i + 3]);
+    pid->kd = (float)atof(argv[*i + 4]);
+    *i += 4;
+    return 0;
+}
+
+static int parse_sched(char **argv, int argc, int *i, sim_options_t *opt)
+{
+    if (*i + 5 >= argc || opt->num_sched >= MAX_SCHED_ARGS) return -1;
+    const char *which = argv[*i + 2];
+    if (strcmp(which, "box") != 0 && strcmp(which, "heat") != 0 && strcmp(which, "cool") != 0) return -1;
+    sched_arg_t *a = &opt->sched[opt->num_sched++];
+    a->target = (float)atof(argv[*i + 1]);
+    a->which = which[0];
+    a->gains.kp = (float)atof(argv[*i + 3]);
+    a->gains.ki = (float)atof(argv[*i + 4]);
+    a->gains.kd = (float)atof(argv[*i + 5]);
+    *i += 5;
+    return 0;
+}
+
+/**
+ * @brief  从CSV读取前馈表，每行 "temp,value"，无法解析的行（表头、注释）跳过
+ */
+static int load_ff_csv(const char *path, ff_table_t *table)
+{
+    FILE *f = fopen(path, "r");
+    char line[128];
+    float temp, value;
+
+    if (f == NULL) return -1;
+    table->count = 0;
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        if (sscanf(line, "%f,%f", &temp, &value) != 2) continue;
+        if (ff_table_set(table, temp, value) < 0) { fclose(f); return -1; }
+    }
+    fclose(f);
+    return table->count > 0 ? 0 : -1;
+}
+
+static const char *state_name(control_state_t state)
+{
+    switch (state)
+    {
+        case CONTROL_STATE_HEATING: return "HEATING";
+        case CONTROL_STATE_WARMING: return "WARMING";
+        case CONTROL_STATE_COOLING: return "COOLING";
+        default:                    return "ERROR!!!";
+    }
+}
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [options]\n", prog);
+    printf("  --profile <t:temp,...>       Target profile, t accepts s/m/h suffix (default 0:45,8h:60,16h:30)\n");
+    printf("  --duration <t>               Simulated time (default 24h)\n");
+    printf("  --env <temp>                 Ambient temperature in C (default 22)\n");
+    printf("  --gain <box|heat|cool> <kp> <ki> <kd>  Override controller gains\n");
+    printf("  --dht-res <C>                DHT11 resolution (default 1.0)\n");
+    printf("  --dht-tau <s>                DHT11 response time constant (default 6)\n");
+    printf("  --ntc-noise <C>              NTC noise stddev (default 0.05)\n");
+    printf("  --seed <n>                   Noise seed (default 1)\n");
+    printf("  --csv <file> [period]        Write trace, sampled every period (default 1s)\n");
+    printf("  --eval-ptc <temp> <ms>       Mimic firmware eval_ptc, prints EVAL_RESULT\n");
+    printf("  --no-estimator               Feed raw DHT11 readings to the outer loop\n");
+    printf("  --mpc                        Use model-predictive control instead of the cascade PID\n");
+    printf("  --ident-apply <t>            Regenerate feedforward tables from the online fit at time t\n");
+    printf("  --sched <temp> <box|heat|cool> <kp> <ki> <kd>  Add a gain schedule point (repeatable)\n");
+    printf("  --ff <0|1> <file>            Replace the ptc (0) or warming (1) feedforward table from a temp,value CSV\n");
+    printf("  --quiet                      Only print result lines\n");
+}
+
+/*******************************************************************************
+ * 仿真主循环
+ ******************************************************************************/
+static void run(const sim_options_t *opt, sim_metrics_t *m)
+{
+    thermal_plant_params_t params;
+    thermal_plant_t plant;
+    FILE *csv = NULL;
+
+    thermal_plant_default(&params);
+    thermal_plant_init(&plant, &params, opt->t_env);
+    rng_state = opt->seed ? opt->seed : 1;
+
+    memset(m, 0, sizeof(*m));
+    m->max_overshoot = 0.0f;
+
+    /* 与固件上电状态一致 */
+    int relay_cool = 0;                     // STATE_PIN: 0-PTC 1-风扇
+    float pwm_out = 0.0f;
+    long blank_until_ms = -1;               // 状态切换的PWM关断窗口
+    float dht_filtered = opt->t_env;
+    float dht_reading = opt->t_env;
+    int reached_target = 0;
+    float last_target = profile_target(opt, 0.0);
+
+    env_temperature = opt->t_env;
+    current_temperature = opt->t_env;
+    ptc_temperature = opt->t_env;
+    target_temperature = opt->eval_target >= 0.0f ? opt->eval_target : last_target;
+    control_estimate_init(ptc_temperature, current_temperature);
+    if (opt->mpc || opt->num_sched > 0 || opt->ff_loaded[0] || opt->ff_loaded[1])
+    {
+        /* 与 tune mode / tune sched / tune ff load 相同，经参数集在第一个控制周期换入 */
+        control_params_t p;
+        control_params_get(&p);
+        p.target_temperature = target_temperature;          // 仿真器直接改写目标温度和 --gain，不经参数集
+        p.box = (pid_gains_t){ pid_box.kp, pid_box.ki, pid_box.kd };
+        p.heat = (pid_gains_t){ pid_ptc.kp, pid_ptc.ki, pid_ptc.kd };
+        p.cool = (pid_gains_t){ pid_cool.kp, pid_cool.ki, pid_cool.kd };
+        if (opt->mpc) p.mode = CONTROL_MODE_MPC;
+        for (int i = 0; i < opt->num_sched; i++)
+        {
+            const sched_arg_t *a = &opt->sched[i];
+            int k = gain_sched_upsert(&p, a->target);
+            if (k < 0) break;
+            if (a->which == 'b') p.sched[k].box = a->gains;
+            else if (a->which == 'h') p.sched[k].heat = a->gains;
+            else p.sched[k].cool = a->gains;
+        }
+        if (opt->ff_loaded[0]) p.ff = opt->ff[0];
+        if (opt->ff_loaded[1]) p.warming_ff = opt->ff[1];
+        control_params_commit(&p);
+    }
+
+    if (opt->eval_target >= 0.0f)
+    {
+        /* eval_ptc：强制进入WARMING并清空PID，PID线程仍照常运行；目标温度已在上面随参数集提交 */
+        control_state = CONTROL_STATE_WARMING;
+        control_reset_pid(&pid_ptc);
+        control_reset_pid(&pid_box);
+    }
+
+    if (opt->csv_path)
+    {
+        csv = fopen(opt->csv_path, "w");
+        if (csv == NULL)
+        {
+            fprintf(stderr, "Cannot open %s\n", opt->csv_path);
+        }
+        else
+        {
+            fprintf(csv, "time_s,target,box,box_meas,box_est,box_std,ptc,ptc_target,env,duty,power,state\n");
+        }
+    }
+    long csv_period_ms = (long)(opt->csv_period_s * 1000.0);
+    if (csv_period_ms < PLANT_STEP_MS) csv_period_ms = PLANT_STEP_MS;
+
+    double duration_s = opt->eval_target >= 0.0f ? opt->eval_duration_s : opt->duration_s;
+    long duration_ms = (long)(duration_s * 1000.0);
+    double eval_error = 0.0;
+    long eval_samples = 0;
+
+    for (long now_ms = 0; now_ms < duration_ms; now_ms += PLANT_STEP_MS)
+    {
+        double now_s = now_ms / 1000.0;
+        if (opt->eval_target < 0.0f)
+        {
+            float target = profile_target(opt, now_s);
+            if (target != last_target)
+            {
+                last_target = target;
+                reached_target = 0;
+            }
+            target_temperature = target;
+        }
+
+        /* DHT11：一阶滞后 + 量化 */
+        dht_filtered += (plant.t_box - dht_filtered) * (PLANT_STEP_MS / 1000.0f) / opt->dht_tau;
+
+        /* 主线程：采样与状态机 */
+        if (now_ms % SAMPLE_PERIOD_MS == 0)
+        {
+            env_temperature = plant.t_env;
+            dht_reading = roundf(dht_filtered / opt->dht_resolution) * opt->dht_resolution;
+            if (opt->no_estimator) current_temperature = dht_reading;
+            else control_estimate_box(dht_reading, 0.0f);
+            current_humidity = 50.0f;
+
+            control_state_t previous_state = control_state;
+            control_state = control_select_state(previous_state, current_temperature);
+            if (control_state != previous_state)
+            {
+                pwm_out = 0.0f;
+                blank_until_ms = now_ms + STATE_SWITCH_MS;
+                control_on_state_change(control_state);
+                relay_cool = (control_state == CONTROL_STATE_COOLING);
+                m->state_switches++;
+            }
+        }
+
+        /* PID线程 */
+        if (now_ms % CONTROL_PERIOD_MS == 0)
+        {
+            ptc_temperature = plant.t_ptc + rng_gauss() * opt->ntc_noise;
+            clock_t start = clock();
+            if (!opt->no_estimator) control_estimate(CONTROL_PERIOD_MS / 1000.0f, !relay_cool);
+            control_identify(CONTROL_PERIOD_MS / 1000.0f, !relay_cool, dht_reading);
+            control_step(CONTROL_PERIOD_MS / 1000.0f);
+            double compute_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+            control_timing_compute((float)compute_s);
+            m->compute_total += compute_s;
+            m->compute_cycles++;
+            if (now_ms >= blank_until_ms) pwm_out = final_pwm_duty;
+
+            if (opt->eval_target >= 0.0f)
+            {
+                eval_error += fabs(ptc_temperature - opt->eval_target);
+                eval_samples++;
+            }
+        }
+
+        /* 与 ident apply 相同：经参数集在下一个控制周期换入 */
+        if (opt->ident_apply_s >= 0.0 && now_ms == (long)(opt->ident_apply_s * 1000.0))
+        {
+            control_params_t p;
+            control_params_get(&p);
+            p.target_temperature = target_temperature;      // 仿真器直接改写目标温度和 --gain，不经参数集
+            p.box = (pid_gains_t){ pid_box.kp, pid_box.ki, pid_box.kd };
+            p.heat = (pid_gains_t){ pid_ptc.kp, pid_ptc.ki, pid_ptc.kd };
+            p.cool = (pid_gains_t){ pid_cool.kp, pid_cool.ki, pid_cool.kd };
+            if (control_ident_tables(&p, &plant_ident.model, env_temperature) == 0) control_params_commit(&p);
+            else if (!opt->quiet) printf("ident apply at %.0f s: model not converged\n", now_s);
+        }
+
+        thermal_plant_step(&plant, relay_cool ? 0.0f : pwm_out, relay_cool ? pwm_out : 0.0f, PLANT_STEP_MS / 1000.0f);
+
+        /* 统计 */
+        float err = plant.t_box - target_temperature;
+        m->iae += fabs(err) * (PLANT_STEP_MS / 1000.0);
+        m->time_total += PLANT_STEP_MS / 1000.0;
+        m->time_in_state[control_state] += PLANT_STEP_MS / 1000.0;
+        if (plant.t_ptc > m->max_ptc) m->max_ptc = plant.t_ptc;
+        if (!reached_target && fabsf(err) < 0.5f) reached_target = 1;
+        if (reached_target && err > m->max_overshoot) m->max_overshoot = err;
+
+        if (csv && now_ms % csv_period_ms == 0)
+        {
+            fprintf(csv, "%.2f,%.2f,%.3f,%.2f,%.3f,%.3f,%.3f,%.3f,%.2f,%.4f,%.3f,%s\n",
+                    now_s, target_temperature, plant.t_box, dht_reading, current_temperature,
+                    sqrtf(box_estimator.P[1][1]), plant.t_ptc,
+                    ptc_target_temp, plant.t_env, pwm_out, plant.power, state_name(control_state));
+        }
+    }
+
+    if (csv) fclose(csv);
+
+    if (opt->eval_target >= 0.0f)
+    {
+        /* 与固件 eval_ptc 输出格式一致，便于 evaluate.py 复用解析 */
+        if (eval_samples == 0) printf("EVAL_RESULT:999999.0\n");
+        else printf("EVAL_RESULT:%.4f\n", eval_error / eval_samples);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    sim_options_t opt;
+    sim_metrics_t m;
+
+    memset(&opt, 0, sizeof(opt));
+    parse_profile("0:45,8h:60,16h:30", &opt);
+    opt.duration_s = 24 * 3600.0;
+    opt.t_env = 22.0f;
+    opt.dht_resolution = 1.0f;
+    opt.dht_tau = 6.0f;
+    opt.ntc_noise = 0.05f;
+    opt.seed = 1;
+    opt.csv_period_s = 1.0;
+    opt.eval_target = -1.0f;
+    opt.ident_apply_s = -1.0;
+
+    control_init();
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        int has_val = (i + 1 < argc);
+        if (strcmp(arg, "--profile") == 0 && has_val) {
+            if (parse_profile(argv[++i], &opt) != 0) { fprintf(stderr, "Invalid profile '%s'\n", argv[i]); return 1; }
+        } else if (strcmp(arg, "--duration") == 0 && has_val) {
+            if (parse_time(argv[++i], &opt.duration_s) != 0) { fprintf(stderr, "Invalid duration '%s'\n", argv[i]); return 1; }
+        } else if (strcmp(arg, "--env") == 0 && has_val) {
+            opt.t_env = (float)atof(argv[++i]);
+        } else if (strcmp(arg, "--gain") == 0) {
+            if (parse_gain(argv, argc, &i) != 0) { fprintf(stderr, "Usage: --gain <box|heat|cool> <kp> <ki> <kd>\n"); return 1; }
+        } else if (strcmp(arg, "--dht-res") == 0 && has_val) {
+            opt.dht_resolution = (float)atof(argv[++i]);
+            if (opt.dht_resolution <= 0.0f) opt.dht_resolution = 0.01f;
+        } else if (strcmp(arg, "--dht-tau") == 0 && has_val) {
+            opt.dht_tau = (float)atof(argv[++i]);
+            if (opt.dht_tau < 0.01f) opt.dht_tau = 0.01f;
+        } else if (strcmp(arg, "--ntc-noise") == 0 && has_val) {
+            opt.ntc_noise = (float)atof(argv[++i]);
+        } else if (strcmp(arg, "--seed") == 0 && has_val) {
+            opt.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--csv") == 0 && has_val) {
+            opt.csv_path = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-') parse_time(argv[++i], &opt.csv_period_s);
+        } else if (strcmp(arg, "--eval-ptc") == 0 && i + 2 < argc) {
+            opt.eval_target = (float)atof(argv[++i]);
+            opt.eval_duration_s = atof(argv[++i]) / 1000.0;
+        } else if (strcmp(arg, "--no-estimator") == 0) {
+            opt.no_estimator = 1;
+        } else if (strcmp(arg, "--mpc") == 0) {
+            opt.mpc = 1;
+        } else if (strcmp(arg, "--sched") == 0) {
+            if (parse_sched(argv, argc, &i, &opt) != 0) { fprintf(stderr, "Usage: --sched <temp> <box|heat|cool> <kp> <ki> <kd>\n"); return 1; }
+        } else if (strcmp(arg, "--ff") == 0 && i + 2 < argc) {
+            int k = atoi(argv[++i]) ? 1 : 0;
+            if (load_ff_csv(argv[++i], &opt.ff[k]) != 0) {
+                fprintf(stderr, "Cannot load feedforward table '%s' (at most %d temp,value rows)\n", argv[i], CONTROL_FF_CAPACITY);
+                return 1;
+            }
+            opt.ff_loaded[k] = 1;
+        } else if (strcmp(arg, "--ident-apply") == 0 && has_val) {
+            if (parse_time(argv[++i], &opt.ident_apply_s) != 0) { fprintf(stderr, "Invalid time '%s'\n", argv[i]); return 1; }
+        } else if (strcmp(arg, "--quiet") == 0) {
+            opt.quiet = 1;
+        } else {
+            usage(argv[0]);
+            return strcmp(arg, "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    run(&opt, &m);
+
+    if (opt.eval_target >= 0.0f) return 0;
+
+    double mae = m.time_total > 0.0 ? m.iae / m.time_total : 0.0;
+    if (!opt.quiet)
+    {
+        printf("----- Simulation Summary -----\n");
+        printf("Simulated time:       %.1f h\n", m.time_total / 3600.0);
+        printf("IAE (box):            %.1f C*s\n", m.iae);
+        printf("Mean |error|:         %.3f C\n", mae);
+        printf("Max overshoot:        %.2f C\n", m.max_overshoot);
+        printf("Max PTC temp:         %.2f C\n", m.max_ptc);
+        printf("State switches:       %d\n", m.state_switches);
+        printf("Time HEAT/WARM/COOL:  %.1f%% / %.1f%% / %.1f%%\n",
+               100.0 * m.time_in_state[CONTROL_STATE_HEATING] / m.time_total,
+               100.0 * m.time_in_state[CONTROL_STATE_WARMING] / m.time_total,
+               100.0 * m.time_in_state[CONTROL_STATE_COOLING] / m.time_total);
+        const ident_model_t *id = &plant_ident.model;
+        printf("Ident PTC tau/gain:   %.1f s / %.1f C (fit %.2f, +/-%.1f%%, %u windows)\n",
+               id->tau_ptc, id->k_ptc, id->fit_ptc, 100.0f * id->unc_ptc, (unsigned int)id->samples_ptc);
+        printf("Ident box tau/ratio:  %.0f s / %.3f (fit %.2f, +/-%.1f%%, %u windows)%s\n",
+               id->tau_box, id->k_box, id->fit_box, 100.0f * id->unc_box, (unsigned int)id->samples_box,
+               id->valid ? "" : " [not converged]");
+        if (m.compute_cycles > 0)
+            printf("Compute (host) avg/max: %.1f / %.1f us\n",
+                   1e6 * m.compute_total / m.compute_cycles, 1e6 * control_timing.compute_max);
+    }
+    printf("SIM_RESULT:%.4f,%.3f,%d\n", mae, m.max_overshoot, m.state_switches);
+    return 0;
+}
@@ -3,6 +3,7 @@
 
 #include <rtthread.h>
 #include "drv_pin.h"
+#include "control.h"
 /*******************************************************************************
  * 参数定义
  ******************************************************************************/
@@ -20,49 +21,14 @@ typedef struct rt_device_pwm* rt_pwm_t;
 #define NTC_SERIES_R        10000.0f  		// 分压串联电阻 10k
 #define ADC_REF_VOLTAGE     3300      		// 参考电压（mv）
 #define ADC_RESOLUTION      65535.0f  		// 16bit ADC
-#define SAMPLE_PERIOD_MS    1000          	// 主线程采样周期 (ms)
-#define CONTROL_PERIOD_MS 	100         	// PID控制周期 (ms)
-
-/* 传感器信息 */
-extern volatile float env_temperature;        // 环境温度
-extern volatile float current_humidity;       // 当前湿度值
-extern volatile float current_temperature;    // 当前温度值
-extern volatile float target_temperature;     // 目标温度值
-extern volatile float ptc_temperature;        // PTC温度值
-extern volatile float ptc_target_temp;        // PTC目标温度
-/* 温控参数 */
-extern float warming_threshold;       // 当前保温阈值 (由前馈表决定)
-extern float warming_bias;            // 保温偏置温度（PTC温度高于目标温度多少用于保温）
-extern float heating_bias;           // 加热偏置温度（PTC温度高于目标温度多少用于加热）
-extern float hysteresis_band;         // 迟滞范围
-extern float fan_min;                // 最小风速
-extern float fan_max;                // 最大风速
+#define PTC_SENSOR_FAULT_CYCLES 5         // 连续多少个控制周期读不到 ADC 采样视为PTC传感器故障
 
 /* 控制状态与监控变量 */
-/* PID 控制器 */
-typedef struct {
-    float kp;
-    float ki;
-    float kd;
-    float integral;
-    float prev_error;
-    float out_min;
-    float out_max;
-} pid_ctx_t;
-extern pid_ctx_t pid_box;  // 外环PID控制PTC目标温度
-extern pid_ctx_t pid_ptc;  // 内环PID控制PTC温度
-extern pid_ctx_t pid_cool; // 风扇 PI
-typedef enum {
-	CONTROL_STATE_HEATING=0,
-	CONTROL_STATE_WARMING,
-	CONTROL_STATE_COOLING
-} control_state_t;
-extern volatile control_state_t control_state;
 extern volatile rt_uint32_t ptc_state;
-extern volatile float final_pwm_duty;          // 当前PWM占空比
 
 // 控制接口
-extern void tune(int argc, char **argv);
+extern int tune(int argc, char **argv);
+extern int tune_apply(int argc, char **argv);
 extern void remote_start(int argc, char **argv);
 
 // OLED显示
@@ -0,0 +1,113 @@
+#include <rtdevice.h>
+#include <string.h>
+#include "telemetry.h"
+
+/*******************************************************************************
+ * 参数定义
+ ******************************************************************************/
+/* 池大小为记录长度的整数倍，put_force 覆盖时记录不会跨越缓冲区末尾 */
+#define TELEMETRY_POOL_SIZE     (APP_TELEMETRY_RECORDS * sizeof(telemetry_record_t))
+
+static struct rt_ringbuffer telemetry_rb;
+static rt_uint8_t telemetry_pool[TELEMETRY_POOL_SIZE];
+static rt_uint32_t telemetry_next_seq = 0;     // 下一条记录的序号
+
+/*******************************************************************************
+ * 函数定义
+ ******************************************************************************/
+static rt_int16_t to_centi(float value)
+{
+    float scaled = value * 100.0f;
+    if (scaled > 32767.0f) return 32767;
+    if (scaled < -32768.0f) return -32768;
+    return (rt_int16_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+}
+
+static rt_uint16_t to_centi_u(float value)
+{
+    float scaled = value * 100.0f;
+    if (scaled > 65535.0f) return 65535;
+    if (scaled < 0.0f) return 0;
+    return (rt_uint16_t)(scaled + 0.5f);
+}
+
+void telemetry_init(void)
+{
+    RT_ASSERT(TELEMETRY_POOL_SIZE % RT_ALIGN_SIZE == 0);
+    rt_ringbuffer_init(&telemetry_rb, telemetry_pool, sizeof(telemetry_pool));
+    telemetry_next_seq = 0;
+}
+
+/**
+ * @brief  追加一条控制周期记录（由PID线程调用）
+ * @param  snap 本周期发布的状态快照
+ */
+void telemetry_append(const control_snapshot_t *snap)
+{
+    telemetry_record_t rec;
+
+    rec.timestamp_ms = snap->timestamp_ms;
+    rec.ptc_temp = to_centi(snap->ptc_temperature);
+    rec.box_temp = to_centi(snap->current_temperature);
+    rec.target_temp = to_centi(snap->target_temperature);
+    rec.ptc_target_temp = to_centi(snap->ptc_target_temp);
+    rec.env_temp = to_centi(snap->env_temperature);
+    rec.humidity = to_centi_u(snap->current_humidity);
+    rec.duty = to_centi_u(snap->pwm_duty * 100.0f);
+    rec.state = (rt_uint8_t)snap->state;
+    rec.flags = snap->relay_heat ? TELEMETRY_FLAG_RELAY_HEAT : 0;
+    rec.box_error = snap->pid_box.prev_error;
+    rec.box_integral = snap->pid_box.integral;
+    rec.ptc_error = snap->pid_ptc.prev_error;
+    rec.ptc_integral = snap->pid_ptc.integral;
+
+    rt_enter_critical();
+    rec.seq = telemetry_next_seq;
+    rt_ringbuffer_put_force(&telemetry_rb, (const rt_uint8_t *)&rec, sizeof(rec));
+    telemetry_next_seq++;
+    rt_exit_critical();
+}
+
+/**
+ * @brief  查询从 since_seq 起仍在缓冲中的记录
+ * @param  since_seq 期望的起始序号
+ * @param  first_seq 输出，实际可取的起始序号（早于缓冲区的部分已被覆盖）
+ * @return 可取的记录条数，since_seq 超过最新记录时为 0
+ */
+rt_uint32_t telemetry_range(rt_uint32_t since_seq, rt_uint32_t *first_seq)
+{
+    rt_uint32_t count, oldest, next;
+
+    rt_enter_critical();
+    count = rt_ringbuffer_data_len(&telemetry_rb) / sizeof(telemetry_record_t);
+    next = telemetry_next_seq;
+    rt_exit_critical();
+
+    oldest = next - count;
+    if (since_seq < oldest) since_seq = oldest;
+    *first_seq = since_seq;
+    return (since_seq < next) ? next - since_seq : 0;
+}
+
+/**
+ * @brief  按序号复制一条记录，不从缓冲中移除
+ * @return 记录已被覆盖或尚未产生时返回 RT_FALSE
+ * @note   每次只锁调度器复制 40 字节，PID线程最多被推迟几微秒
+ */
+rt_bool_t telemetry_read(rt_uint32_t seq, telemetry_record_t *rec)
+{
+    rt_bool_t found = RT_FALSE;
+
+    rt_enter_critical();
+    rt_uint32_t count = rt_ringbuffer_data_len(&telemetry_rb) / sizeof(telemetry_record_t);
+    rt_uint32_t oldest = telemetry_next_seq - count;
+    if (seq >= oldest && seq < telemetry_next_seq)
+    {
+        rt_uint32_t pos = (telemetry_rb.read_index + (seq - oldest) * sizeof(telemetry_record_t))
+                          % telemetry_rb.buffer_size;
+        memcpy(rec, &telemetry_rb.buffer_ptr[pos], sizeof(*rec));
+        found = RT_TRUE;
+    }
+    rt_exit_critical();
+    return found;
+}
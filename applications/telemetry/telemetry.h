@@ -0,0 +1,44 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/*******************************************************************************
+ * 控制周期遥测环形缓冲
+ *
+ * PID线程每个控制周期追加一条定长二进制记录，缓冲满时覆盖最旧的记录。
+ * 远程 history 命令按序号取出缺失区间，一次性发给上位机，
+ * 从而得到完整的 10 Hz 曲线，而不依赖 get_status 轮询。
+ ******************************************************************************/
+#include <rtthread.h>
+#include "control.h"
+
+#ifndef APP_TELEMETRY_RECORDS
+#define APP_TELEMETRY_RECORDS   300
+#endif
+
+#define TELEMETRY_FLAG_RELAY_HEAT   0x01    // 继电器处于加热侧
+
+/* 单条记录，小端、自然对齐，共 40 字节（上位机按同样布局解析） */
+typedef struct {
+    rt_uint32_t seq;              // 记录序号，单调递增
+    rt_uint32_t timestamp_ms;     // 记录时刻 (ms)
+    rt_int16_t ptc_temp;          // PTC温度 (0.01°C)
+    rt_int16_t box_temp;          // 箱内温度 (0.01°C)
+    rt_int16_t target_temp;       // 目标温度 (0.01°C)
+    rt_int16_t ptc_target_temp;   // PTC目标温度 (0.01°C)
+    rt_int16_t env_temp;          // 环境温度 (0.01°C)
+    rt_uint16_t humidity;         // 湿度 (0.01%)
+    rt_uint16_t duty;             // 占空比 (0.01%)
+    rt_uint8_t state;             // control_state_t
+    rt_uint8_t flags;             // TELEMETRY_FLAG_*
+    float box_error;              // 外环误差
+    float box_integral;           // 外环积分
+    float ptc_error;              // 内环误差
+    float ptc_integral;           // 内环积分
+} telemetry_record_t;
+
+void telemetry_init(void);
+void telemetry_append(const control_snapshot_t *snap);
+rt_uint32_t telemetry_range(rt_uint32_t since_seq, rt_uint32_t *first_seq);
+rt_bool_t telemetry_read(rt_uint32_t seq, telemetry_record_t *rec);
+
+#endif /* TELEMETRY_H */
@@ -1,11 +1,14 @@
 import serial
 import time
-from skopt import gp_minimize
+from skopt import gp_minimize, Optimizer
 from skopt.space import Real
 from skopt.plots import plot_convergence
+from concurrent.futures import ThreadPoolExecutor
+import argparse
 import json
 import os
 import re
+import subprocess
 import matplotlib.pyplot as plt
 from tqdm import tqdm  # 进度条
 
@@ -50,6 +53,42 @@ TARGET_PROFILES = [
     },
 ]
 
+# 仿真调参配置（--sim）
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+SIM_DIR = os.path.normpath(os.path.join(SCRIPT_DIR, "..", "sim"))
+SIM_BINARY = os.path.join(SIM_DIR, "thermal_sim.exe" if os.name == "nt" else "thermal_sim")
+SIM_TOTAL_CALLS_PER_PROFILE = 400   # 仿真评估次数（远多于实机）
+SIM_WORKERS = os.cpu_count() or 1   # 每批并行评估数，一核一个
+SIM_CONFIRM_TOP_K = 3               # 仿真前K名在实机上复核，0 表示不复核
+SIM_OVERSHOOT_WEIGHT = 2.0          # 闭环评分中超调的权重
+
+# 仅在仿真中整定的外环/风冷控制器（实机没有对应的独立评估命令）
+SIM_EXTRA_PROFILES = [
+    {
+        "name": "Box_48C",
+        "controller": "box",
+        "target_temp": 48.0,
+        "sim_args": ["--profile", "0:48", "--duration", "3h"],
+        "space": [
+            Real(0.0, 2.0, name='kp'),
+            Real(0.0, 2.0, name='ki'),
+            Real(0.0, 2.0, name='kd')
+        ],
+        "initial_params": [0.10, 0.76, 0.37],
+    },
+    {
+        "name": "Cool_30C",
+        "controller": "cool",
+        "target_temp": 30.0,
+        "sim_args": ["--profile", "0:60,2h:30", "--duration", "4h"],
+        "space": [
+            Real(0.001, 0.5, name='kp'),
+            Real(0.0001, 0.05, name='ki')
+        ],
+        "initial_params": [0.01, 0.001],
+    },
+]
+
 # 全局变量
 ser = None
 current_target_temp = 0.0
@@ -107,6 +146,14 @@ def send_cmd(cmd_to_send, wait_time=0.1):
         print("Error: Serial port is not open.")
 
 
+def send_tune_batch(settings, wait_time=0.05):
+    """以一个 tune 事务下发多个参数，板端在同一个控制周期整体换入，避免中间出现半新半旧的增益组合。"""
+    send_cmd("tune begin", wait_time=wait_time)
+    for setting in settings:
+        send_cmd(f"tune set {setting}", wait_time=wait_time)
+    send_cmd("tune commit", wait_time=0.2)  # commit 会等待换入并打印状态
+
+
 def send_cmd_and_read(cmd_to_send, timeout=1.0):
     """
     发送命令并读取返回（用于 get_status 之类需要解析输出的命令）.
@@ -176,10 +223,7 @@ def reset_system():
     print("\n--- Resetting system: force COOLING until PTC ~= box temp ---")
 
     # 关掉 heat PID 的积分/输出，避免乱加热
-    send_cmd("tune heat kp 0", wait_time=0.05)
-    send_cmd("tune heat ki 0", wait_time=0.05)
-    send_cmd("tune heat kd 0", wait_time=0.05)
-    send_cmd(f"tune target 20", wait_time=0.05)
+    send_tune_batch(["heat kp 0", "heat ki 0", "heat kd 0", "target 20"])
 
     # 强制切换到冷却状态（需要你在固件里实现 force_state 命令）
     send_cmd("force_state cooling", wait_time=0.1)
@@ -237,13 +281,15 @@ def objective_function(params):
     if pbar_inner is not None:
         pbar_inner.set_description(f"Kp={kp_str}, Ki={ki_str}, Kd={kd_str}")
 
+    # 板端增益调度表非空时固定增益不生效：候选增益与 sched clear 同一事务下发，评估后再恢复原表
+    schedule = read_gain_schedule()
+
     # 1. 冷却
     reset_system()
 
     # 2. 设置 PID 参数
-    send_cmd(f"tune heat kp {kp_str}", wait_time=0.05)
-    send_cmd(f"tune heat ki {ki_str}", wait_time=0.05)
-    send_cmd(f"tune heat kd {kd_str}", wait_time=0.05)
+    send_tune_batch((["sched clear"] if schedule else []) +
+                    [f"heat kp {kp_str}", f"heat ki {ki_str}", f"heat kd {kd_str}"])
 
     # 3. 启动评估
     send_cmd(f"eval_ptc {current_target_temp} {EVAL_DURATION_MS}", wait_time=0)
@@ -276,17 +322,221 @@ def objective_function(params):
         if pbar_inner is not None:
             pbar_inner.write("Timeout: no EVAL_RESULT received.")
 
+    if schedule:
+        send_tune_batch(["sched clear"] + schedule)
+        if len(read_gain_schedule()) != len(schedule):
+            raise RuntimeError("Failed to restore the board gain schedule after evaluation.")
+
     if pbar_inner is not None:
         pbar_inner.write(f"Score={score:.4f} for Kp={kp_str}, Ki={ki_str}, Kd={kd_str}")
         pbar_inner.update(1)
 
     return score
 
+def gain_schedule_settings(all_results):
+    """
+    把各 profile 的最优增益转换为板端增益调度表的 tune 参数（sched <temp> <controller> kp ki kd）。
+    按温度升序下发：板端插入新温度点时，未整定的控制器沿用该温度处已有的插值增益。
+    """
+    settings = []
+    for _, data in sorted(all_results.items(),
+                          key=lambda it: (it[1]["target_temp"], it[1].get("controller", "heat"))):
+        p = data["best_params"]
+        settings.append(f"sched {data['target_temp']:.1f} {data.get('controller', 'heat')} "
+                        f"{p['Kp']:.6f} {p['Ki']:.6f} {p['Kd']:.6f}")
+    return settings
+
+
+def read_gain_schedule():
+    """
+    读取板端已提交的增益调度表（tune sched），转换为可原样重新下发的 tune 参数列表；表为空时返回 []。
+    列表输出无法解析时直接报错，避免在调度表生效的情况下误评估固定增益。
+    """
+    out = send_cmd_and_read("tune sched", timeout=1.0)
+    if "Gain schedule is empty" in out:
+        return []
+
+    settings = []
+    num = r"([-\d\.]+)"
+    pattern = re.compile(rf"{num}\s*C\s+box {num}/{num}/{num}\s+heat {num}/{num}/{num}\s+cool {num}/{num}/{num}")
+    for line in out.splitlines():
+        m = pattern.search(line)
+        if not m:
+            continue
+        temp, *gains = m.groups()
+        for i, controller in enumerate(("box", "heat", "cool")):
+            kp, ki, kd = gains[3 * i:3 * i + 3]
+            settings.append(f"sched {temp} {controller} {kp} {ki} {kd}")
+
+    if not settings:
+        raise RuntimeError(f"Cannot parse the board gain schedule from 'tune sched':\n{out}")
+    return settings
+
+
+def print_gain_schedule(all_results):
+    """全部完成后输出增益调度表"""
+    print("\n" + "=" * 60)
+    print("           ALL OPTIMIZATIONS COMPLETE           ")
+    print("=" * 60)
+    print("Final Gain Schedule (MSH, or rerun with --push):\n")
+    print("tune sched clear")
+    for setting in gain_schedule_settings(all_results):
+        print(f"tune {setting}")
+
+
+def push_gain_schedule(all_results):
+    """以一个 tune 事务把增益调度表整体下发到板端（先清空旧表）"""
+    settings = gain_schedule_settings(all_results)
+    if not settings:
+        print("No results to push.")
+        return
+    send_tune_batch(["sched clear"] + settings)
+    print(f"Pushed {len(settings)} gain schedule settings to the board.")
+    print(send_cmd_and_read("tune sched", timeout=1.0))
+
+# ==============================================================================
+# 仿真批量评估
+# ==============================================================================
+
+def ensure_sim_binary():
+    """仿真器不存在时用 gcc 编译（见 sim/thermal_sim.c 头部说明）。"""
+    if os.path.exists(SIM_BINARY):
+        return
+    print(f"Building simulator '{SIM_BINARY}' ...")
+    subprocess.run(
+        ["gcc", "-O2", "-DCONTROL_SIM", "-I../control", "-o", SIM_BINARY,
+         "thermal_sim.c", "thermal_plant.c", "../control/control.c", "../control/estimator.c",
+         "../control/mpc.c", "../control/ident.c", "-lm"],
+        cwd=SIM_DIR, check=True)
+
+
+def sim_objective(profile, params):
+    """
+    在仿真器上评估一组增益，返回 score（越小越好）。
+    heat：与实机相同的 eval_ptc 指标；box/cool：闭环平均误差 + 超调惩罚。
+    """
+    kp, ki, kd = params
+    controller = profile.get("controller", "heat")
+    cmd = [SIM_BINARY, "--quiet", "--gain", controller, f"{kp:.6f}", f"{ki:.6f}", f"{kd:.6f}"]
+    if controller == "heat":
+        cmd += ["--eval-ptc", str(profile["target_temp"]), str(EVAL_DURATION_MS)]
+    else:
+        cmd += profile["sim_args"]
+
+    try:
+        out = subprocess.run(cmd, capture_output=True, text=True, timeout=120).stdout
+    except (subprocess.SubprocessError, OSError):
+        return 1e6
+
+    for line in out.splitlines():
+        if line.startswith("EVAL_RESULT:"):
+            val = float(line.split(':')[1])
+            return val if val > 0 else 1e6
+        if line.startswith("SIM_RESULT:"):
+            mae, overshoot, _ = line.split(':')[1].split(',')
+            return float(mae) + SIM_OVERSHOOT_WEIGHT * float(overshoot)
+    return 1e6
+
+
+def run_sim_profile(profile, pool):
+    """
+    批量贝叶斯优化：每轮 ask 出 SIM_WORKERS 个候选点（constant liar 策略），
+    并行送入仿真器评估后一起 tell，返回按分数排序的 [(score, [kp, ki, kd]), ...]。
+    """
+    optimizer = Optimizer(
+        dimensions=profile["space"],
+        base_estimator="GP",
+        acq_func="gp_hedge",
+        n_initial_points=SIM_WORKERS,
+        random_state=123,
+    )
+
+    def gains(x):
+        # 风冷PI只搜索 kp/ki，kd 补 0
+        return list(x) + [0.0] * (3 - len(x))
+
+    x0 = profile["initial_params"]
+    history = [(sim_objective(profile, gains(x0)), gains(x0))]
+    optimizer.tell(x0, history[0][0])
+
+    pbar = tqdm(total=SIM_TOTAL_CALLS_PER_PROFILE, desc=f"Simulating {profile['name']}", unit="call")
+    while len(history) < SIM_TOTAL_CALLS_PER_PROFILE:
+        batch = optimizer.ask(n_points=SIM_WORKERS, strategy="cl_min")
+        scores = list(pool.map(lambda x: sim_objective(profile, gains(x)), batch))
+        optimizer.tell(batch, scores)
+        history += [(score, gains(x)) for x, score in zip(batch, scores)]
+        pbar.update(len(batch))
+        pbar.set_postfix(best=f"{min(h[0] for h in history):.4f}")
+    pbar.close()
+
+    history.sort(key=lambda h: h[0])
+    return history
+
+
+def run_sim_campaign(profiles, all_results, confirm_top_k):
+    """仿真整定全部 profile；heat 类 profile 的前 K 名再在实机上用 eval_ptc 复核。"""
+    global ser, current_target_temp
+
+    ensure_sim_binary()
+    if confirm_top_k > 0:
+        ser = serial.Serial(SERIAL_PORT, BAUD_RATE, timeout=2)
+        print(f"Successfully connected to serial port {SERIAL_PORT}.")
+        time.sleep(2)
+        ser.reset_input_buffer()
+
+    with ThreadPoolExecutor(max_workers=SIM_WORKERS) as pool:
+        for profile in profiles:
+            name = profile["name"]
+            controller = profile.get("controller", "heat")
+            if name in all_results:
+                print(f"Skip '{name}' (already in {RESULTS_FILE}).")
+                continue
+
+            start = time.time()
+            history = run_sim_profile(profile, pool)
+            print(f"{name}: {len(history)} simulated trials in {time.time() - start:.1f}s, "
+                  f"best sim score {history[0][0]:.4f}")
+
+            best_score, best = history[0]
+            result = {"target_temp": profile["target_temp"], "controller": controller,
+                      "sim_score": float(best_score)}
+
+            if confirm_top_k > 0 and controller == "heat":
+                current_target_temp = profile["target_temp"]
+                confirmed = []
+                for sim_score, params in history[:confirm_top_k]:
+                    hw_score = objective_function(params)
+                    print(f"  hardware {hw_score:.4f} (sim {sim_score:.4f}) for {params}")
+                    confirmed.append((hw_score, params))
+                best_score, best = min(confirmed, key=lambda c: c[0])
+                result["hardware_confirmed"] = True
+            elif confirm_top_k > 0:
+                print(f"  No hardware evaluation for '{controller}' controller, keeping simulated best.")
+
+            result["best_score"] = float(best_score)
+            result["best_params"] = {"Kp": best[0], "Ki": best[1], "Kd": best[2]}
+            all_results[name] = result
+            with open(RESULTS_FILE, "w") as f:
+                json.dump(all_results, f, indent=4)
+            print(f"Checkpoint saved for '{name}'.")
+
 # ==============================================================================
 # MAIN
 # ==============================================================================
 
 if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='PTC PID auto-tuning (serial hardware or simulator)')
+    parser.add_argument('--sim', action='store_true',
+                        help='Tune against the host simulator in parallel batches')
+    parser.add_argument('--confirm', type=int, default=SIM_CONFIRM_TOP_K,
+                        help=f'With --sim, re-evaluate the top N on hardware (default {SIM_CONFIRM_TOP_K}, 0 = none)')
+    parser.add_argument('--workers', type=int, default=SIM_WORKERS,
+                        help=f'With --sim, parallel simulator workers (default {SIM_WORKERS})')
+    parser.add_argument('--push', action='store_true',
+                        help='Write the tuned gains into the on-board gain schedule when done')
+    args = parser.parse_args()
+    SIM_WORKERS = max(1, args.workers)
+
     all_results = {}
 
     print("\n" + "=" * 60)
@@ -307,7 +557,17 @@ if __name__ == '__main__':
     print("=" * 60 + "\n")
 
     try:
-        
+        if args.sim:
+            run_sim_campaign(TARGET_PROFILES + SIM_EXTRA_PROFILES, all_results, args.confirm)
+            print_gain_schedule(all_results)
+            if args.push:
+                if not (ser and ser.is_open):
+                    ser = serial.Serial(SERIAL_PORT, BAUD_RATE, timeout=2)
+                    time.sleep(2)
+                    ser.reset_input_buffer()
+                push_gain_schedule(all_results)
+            raise SystemExit(0)
+
         ser = serial.Serial(SERIAL_PORT, BAUD_RATE, timeout=2)
         print(f"Successfully connected to serial port {SERIAL_PORT}.")
         time.sleep(2)
@@ -370,28 +630,9 @@ if __name__ == '__main__':
             plt.close(fig)
             pbar_outer.write(f"Convergence plot saved to '{plot_filename}'.")
 
-        # 全部完成后输出 C 代码
-        print("\n" + "=" * 60)
-        print("           ALL OPTIMIZATIONS COMPLETE           ")
-        print("=" * 60)
-        print("Final Gain Scheduling Parameters (C-Code):\n")
-
-        formatted_c_code = (
-            "typedef struct { float target_temp; float kp; float ki; float kd; } ptc_pid_profile_t;\n\n"
-            "const ptc_pid_profile_t ptc_pid_table[] = {\n"
-        )
-        sorted_results = sorted(all_results.items(), key=lambda it: it[1]["target_temp"])
-        for name, data in sorted_results:
-            t = data["target_temp"]
-            kp = data["best_params"]["Kp"]
-            ki = data["best_params"]["Ki"]
-            kd = data["best_params"]["Kd"]
-            formatted_c_code += (
-                f"    {{{t:.1f}f, {kp:.6f}f, {ki:.6f}f, {kd:.6f}f}}, "
-                f"// Score: {data['best_score']:.4f}\n"
-            )
-        formatted_c_code += "};"
-        print(formatted_c_code)
+        print_gain_schedule(all_results)
+        if args.push:
+            push_gain_schedule(all_results)
 
         with open(RESULTS_FILE, "w") as f:
             json.dump(all_results, f, indent=4)
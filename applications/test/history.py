@@ -0,0 +1,84 @@
+import csv
+import socket
+import struct
+import sys
+
+# --- 配置 ---
+HOST = '192.168.0.106'  # 替换为你的开发板IP
+PORT = 5000
+OUTPUT_CSV = 'history.csv'
+
+# 与 applications/telemetry/telemetry.h 中 telemetry_record_t 的布局一致（小端，40字节）
+RECORD_FORMAT = '<IIhhhhhHHBBffff'
+RECORD_SIZE = struct.calcsize(RECORD_FORMAT)
+FIELDS = ['seq', 'timestamp_ms', 'ptc_temp', 'box_temp', 'target_temp', 'ptc_target_temp',
+          'env_temp', 'humidity', 'duty', 'state', 'relay_heat',
+          'box_error', 'box_integral', 'ptc_error', 'ptc_integral']
+STATES = {0: 'HEATING', 1: 'WARMING', 2: 'COOLING'}
+
+
+def recv_exact(sock, n):
+    data = bytearray()
+    while len(data) < n:
+        chunk = sock.recv(n - len(data))
+        if not chunk:
+            raise ConnectionError("Connection closed while receiving history.")
+        data.extend(chunk)
+    return bytes(data)
+
+
+def recv_line(sock):
+    line = bytearray()
+    while not line.endswith(b'\r\n'):
+        line.extend(recv_exact(sock, 1))
+    return line[:-2].decode('utf-8')
+
+
+def decode_record(raw):
+    """将一条二进制记录还原为物理量"""
+    (seq, ts, ptc, box, target, ptc_target, env, humi, duty, state, flags,
+     box_err, box_int, ptc_err, ptc_int) = struct.unpack(RECORD_FORMAT, raw)
+    return {
+        'seq': seq, 'timestamp_ms': ts,
+        'ptc_temp': ptc / 100.0, 'box_temp': box / 100.0,
+        'target_temp': target / 100.0, 'ptc_target_temp': ptc_target / 100.0,
+        'env_temp': env / 100.0, 'humidity': humi / 100.0, 'duty': duty / 100.0,
+        'state': STATES.get(state, 'ERROR'), 'relay_heat': flags & 0x01,
+        'box_error': box_err, 'box_integral': box_int,
+        'ptc_error': ptc_err, 'ptc_integral': ptc_int,
+    }
+
+
+def fetch_history(sock, since_seq=0):
+    """发送 history 命令，返回 (first_seq, 记录列表)；first_seq 大于 since_seq 表示有记录已被覆盖"""
+    sock.sendall(f"history {since_seq}\r\n".encode('utf-8'))
+    header = recv_line(sock).split()
+    if len(header) != 4 or header[0] != 'HISTORY':
+        raise ValueError(f"Unexpected reply: {' '.join(header)}")
+    first_seq, count, size = (int(x) for x in header[1:])
+    if size != RECORD_SIZE:
+        raise ValueError(f"Record size mismatch: board {size}, script {RECORD_SIZE}")
+    payload = recv_exact(sock, count * size)
+    records = [decode_record(payload[i * size:(i + 1) * size]) for i in range(count)]
+    # 发送期间被覆盖的记录以全零占位
+    return first_seq, [r for i, r in enumerate(records) if r['seq'] == first_seq + i]
+
+
+if __name__ == '__main__':
+    since = int(sys.argv[1]) if len(sys.argv) > 1 else 0
+    try:
+        with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as s:
+            print(f"Connecting to {HOST}:{PORT}...")
+            s.connect((HOST, PORT))
+            first_seq, records = fetch_history(s, since)
+            if first_seq > since:
+                print(f"Records {since}..{first_seq - 1} already overwritten on board.")
+            with open(OUTPUT_CSV, 'w', newline='') as f:
+                writer = csv.DictWriter(f, fieldnames=FIELDS)
+                writer.writeheader()
+                writer.writerows(records)
+            print(f"Saved {len(records)} records to {OUTPUT_CSV}.")
+    except ConnectionRefusedError:
+        print("Connection refused. Is the server running on the board?")
+    except Exception as e:
+        print(f"An error occurred: {e}")
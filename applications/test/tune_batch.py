@@ -0,0 +1,88 @@
+import csv
+import socket
+import sys
+
+# --- 配置 ---
+HOST = '192.168.0.106'  # 替换为你的开发板IP
+PORT = 5000
+
+# 默认的一组调参命令，可在命令行用 ';' 分隔传入替换
+# begin/commit 之间的修改在同一个控制周期整体生效
+DEFAULT_COMMANDS = [
+    "tune begin",
+    "tune set heat kp 0.3",
+    "tune set heat ki 0.02",
+    "tune set heat kd 0.0",
+    "tune set box kp 2.0",
+    "tune set box ki 0.01",
+    "tune commit",
+    "get_status",
+]
+
+
+# 远程服务器单行命令的缓冲区为 256 字节（remote.c RECV_BUFSZ），留出余量
+MAX_LINE = 240
+
+
+def ff_commands(table, path):
+    """
+    由 CSV（每行 temp,value，表头可有可无）生成整表替换前馈表的 tune 事务：
+    clear 之后按行长上限把点打包进若干条 tune set ff load，commit 时一次换入
+    """
+    points = []
+    with open(path, newline='') as f:
+        for row in csv.reader(f):
+            try:
+                points.append(f"{float(row[0]):g}:{float(row[1]):g}")
+            except (ValueError, IndexError):
+                continue  # 表头或空行
+    prefix = f"tune set ff load {table} "
+    commands = ["tune begin", f"tune set ff clear {table}"]
+    chunk = []
+    for p in points:
+        if chunk and len(prefix) + len(",".join(chunk + [p])) > MAX_LINE:
+            commands.append(prefix + ",".join(chunk))
+            chunk = []
+        chunk.append(p)
+    if chunk:
+        commands.append(prefix + ",".join(chunk))
+    commands.append("tune commit")
+    return commands, len(points)
+
+
+def recv_line(sock, buf):
+    """从 buf（bytearray）与套接字中取出一行，返回去掉行尾的文本"""
+    while b'\n' not in buf:
+        chunk = sock.recv(1024)
+        if not chunk:
+            raise ConnectionError("Connection closed while waiting for reply.")
+        buf.extend(chunk)
+    line, _, rest = bytes(buf).partition(b'\n')
+    buf[:] = rest
+    return line.rstrip(b'\r').decode('utf-8')
+
+
+def pipeline(sock, commands):
+    """一次写出全部命令，再按序读取每条命令的一行回复（仅适用于文本回复的命令）"""
+    sock.sendall("".join(f"{c}\r\n" for c in commands).encode('utf-8'))
+    buf = bytearray()
+    return [recv_line(sock, buf) for _ in commands]
+
+
+if __name__ == '__main__':
+    # 用法：tune_batch.py ["cmd; cmd; ..."] 或 tune_batch.py --ff <0|1> <file.csv>
+    if len(sys.argv) == 4 and sys.argv[1] == '--ff':
+        commands, count = ff_commands(int(sys.argv[2]), sys.argv[3])
+        print(f"Uploading {count} feedforward points in {len(commands) - 3} lines.")
+    else:
+        commands = [c.strip() for c in sys.argv[1].split(';') if c.strip()] if len(sys.argv) > 1 else DEFAULT_COMMANDS
+    try:
+        with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as s:
+            print(f"Connecting to {HOST}:{PORT}...")
+            s.connect((HOST, PORT))
+            for command, reply in zip(commands, pipeline(s, commands)):
+                print(f"{command:<24} -> {reply}")
+    except ConnectionRefusedError:
+        print("Connection refused. Is the server running on the board?")
+    except Exception as e:
+        print(f"An error occurred: {e}")
@@ -15,6 +15,9 @@
 #include "board.h"
 #include "clock_config.h"
 #include "drv_uart.h"
+#ifdef RT_USING_KTIME
+#include <ktime.h>
+#endif
 
 /**
  * This is the timer interrupt service routine.
@@ -103,3 +106,51 @@ void rt_hw_us_delay(rt_uint32_t us)
         }
     }
 }
+
+#ifdef RT_USING_KTIME
+/**
+ * ktime 默认以系统节拍计时，分辨率只有 1 ms。这里用 SysTick 当前计数补足节拍内的时间，
+ * 启动时间的分辨率提高到一个内核时钟周期；节拍计数溢出周期与默认实现相同。
+ */
+static rt_uint64_t board_boottime_ns(void)
+{
+    rt_tick_t tick;
+    rt_uint32_t val, pending, reload = SysTick->LOAD + 1;
+
+    do
+    {
+        tick = rt_tick_get();
+        val = SysTick->VAL;
+        pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+    } while (tick != rt_tick_get());
+
+    /* 计数已重装但节拍中断尚未执行（调用者关中断时），补上这一拍 */
+    if (pending && val > reload / 2)
+    {
+        tick++;
+    }
+
+    return (rt_uint64_t)tick * (1000000000ULL / RT_TICK_PER_SECOND)
+           + (rt_uint64_t)(reload - 1 - val) * (1000000000ULL / RT_TICK_PER_SECOND) / reload;
+}
+
+rt_err_t rt_ktime_boottime_get_ns(struct timespec *ts)
+{
+    RT_ASSERT(ts != RT_NULL);
+
+    rt_uint64_t ns = board_boottime_ns();
+    ts->tv_sec  = ns / 1000000000ULL;
+    ts->tv_nsec = ns % 1000000000ULL;
+    return RT_EOK;
+}
+
+rt_err_t rt_ktime_boottime_get_us(struct timeval *tv)
+{
+    RT_ASSERT(tv != RT_NULL);
+
+    rt_uint64_t ns = board_boottime_ns();
+    tv->tv_sec  = ns / 1000000000ULL;
+    tv->tv_usec = (ns % 1000000000ULL) / 1000;
+    return RT_EOK;
+}
+#endif /* RT_USING_KTIME */
@@ -151,6 +151,14 @@
 
 /* DFS: device virtual file system */
 
+#define RT_USING_DFS
+#define DFS_USING_POSIX
+#define DFS_USING_WORKDIR
+#define DFS_FD_MAX 16
+#define RT_USING_DFS_V1
+#define DFS_FILESYSTEMS_MAX 4
+#define DFS_FILESYSTEM_TYPES_MAX 4
+#define RT_USING_DFS_DEVFS
 /* end of DFS: device virtual file system */
 
 /* Device Drivers */
@@ -206,6 +214,7 @@
 #define RT_WLAN_WORKQUEUE_THREAD_SIZE 2048
 #define RT_WLAN_WORKQUEUE_THREAD_PRIO 15
 #define RT_USING_PIN
+#define RT_USING_KTIME
 #define RT_USING_HWTIMER
 /* end of Device Drivers */
 
@@ -224,6 +233,10 @@
 
 /* POSIX (Portable Operating System Interface) layer */
 
+#define RT_USING_POSIX_FS
+#define RT_USING_POSIX_POLL
+#define RT_USING_POSIX_SELECT
+#define RT_USING_POSIX_SOCKET
 
 /* Interprocess Communication (IPC) */
 
@@ -243,7 +256,7 @@
 
 #define SAL_USING_LWIP
 /* end of Docking with protocol stacks */
-#define SAL_SOCKETS_NUM 16
+#define SAL_USING_POSIX
 #define RT_USING_NETDEV
 #define NETDEV_USING_IFCONFIG
 #define NETDEV_USING_PING
@@ -476,13 +489,6 @@
 
 /* sensors drivers */
 
-#define PKG_USING_DHTXX
-#define PKG_USING_DHTXX_TYPE_DHT11
-#define PKG_DHTXX_USING_SENSOR_V1
-#define PKG_USING_DHTXX_SAMPLE_SENSOR_V1
-#define PKG_USING_DHTXX_DEBUG
-#define PKG_USING_DHTXX_LATEST_VERSION
-#define PKG_DHTXX_VER_NUM 0x99999
 #define PKG_USING_P3T1755
 #define P3T1755_I2C_BUS_NAME "i2c0"
 #define PKG_USING_P3T1755_LATEST_VERSION
@@ -588,6 +594,12 @@
 #define BSP_USING_SPI1
 #define BSP_USING_ADC
 #define BSP_USING_ADC0_CH0
+#define BSP_USING_ADC0_DMA
+#define BSP_ADC0_DMA_CHANNEL 2
+#define BSP_ADC0_DMA_RATE_HZ 320
+#define BSP_ADC0_DMA_WINDOW 32
+#define BSP_USING_HWTIMER
+#define BSP_USING_CTIMER0
 #define BSP_USING_PWM
 #define BSP_USING_PWM0
 #define BSP_USING_PWM1
@@ -623,6 +635,12 @@
 #define PTC_MAX_SAFE_TEMP 110
 /* end of MOS-PTC Configuration */
 
+/* Control Loop Configuration */
+
+#define APP_CONTROL_TIMER_DEV_NAME "timer0"
+#define APP_TELEMETRY_RECORDS 300
+/* end of Control Loop Configuration */
+
 /* WLAN Configuration */
 
 #define APP_WLAN_SSID "142A_SecurityPlus"